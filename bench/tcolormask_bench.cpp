@@ -0,0 +1,119 @@
+// Benchmark of the masking engine, also the training workload of the PGO build (-DPGO=generate).
+// Usage: tcolormask_bench [iterations] [opt]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tcolormask_core.h"
+
+struct BenchCase
+{
+    const char* name;
+    int bits;
+    int subsamplingX;
+    int subsamplingY;
+    int colors;
+    bool euclid;
+    bool soft;
+    bool mt;
+};
+
+// The paths selected by the constructor: few colors (unrolled SIMD), many colors (LUT), euclid, soft, 16-bit, 4:4:4, mt.
+static constexpr BenchCase cases[] = {
+    { "8-bit 4:2:0 box 4 colors", 8, 2, 2, 4, false, false, false },
+    { "8-bit 4:2:0 box 30 colors (lut)", 8, 2, 2, 30, false, false, false },
+    { "8-bit 4:2:0 euclid 4 colors", 8, 2, 2, 4, true, false, false },
+    { "8-bit 4:2:0 euclid 30 colors (lut3d)", 8, 2, 2, 30, true, false, false },
+    { "8-bit 4:2:0 soft 4 colors", 8, 2, 2, 4, false, true, false },
+    { "8-bit 4:4:4 box 4 colors", 8, 1, 1, 4, false, false, false },
+    { "8-bit 4:2:0 box 4 colors mt", 8, 2, 2, 4, false, false, true },
+    { "16-bit 4:2:0 box 4 colors", 16, 2, 2, 4, false, false, false },
+    { "16-bit 4:2:0 box 30 colors (lut)", 16, 2, 2, 30, false, false, false },
+    { "16-bit 4:2:0 euclid 4 colors", 16, 2, 2, 4, true, false, false },
+};
+
+template <typename T>
+static double run(const BenchCase& c, int iterations, int opt)
+{
+    constexpr int width = 1920;
+    constexpr int height = 1080;
+    const int width_uv = width / c.subsamplingX;
+    const int height_uv = height / c.subsamplingY;
+    const int peak = (1 << c.bits) - 1;
+
+    // Smooth gradients with noise, so that a part of the frame matches the colors.
+    std::mt19937 rng(1);
+    std::vector<T> Y(static_cast<size_t>(width) * height), U(static_cast<size_t>(width_uv) * height_uv), V(U.size()), dst(Y.size());
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+            Y[static_cast<size_t>(y) * width + x] = static_cast<T>(std::min<int>(peak, ((x + y) * (peak + 1) / (width + height)) + (rng() & 7)));
+    }
+
+    for (int y = 0; y < height_uv; ++y)
+    {
+        for (int x = 0; x < width_uv; ++x)
+        {
+            U[static_cast<size_t>(y) * width_uv + x] = static_cast<T>(x * (peak + 1) / width_uv);
+            V[static_cast<size_t>(y) * width_uv + x] = static_cast<T>(y * (peak + 1) / height_uv);
+        }
+    }
+
+    TColorMaskParams params;
+    params.width = width;
+    params.height = height;
+    params.subsamplingX = c.subsamplingX;
+    params.subsamplingY = c.subsamplingY;
+    params.euclid = c.euclid;
+    params.soft = c.soft;
+    params.mt = c.mt;
+    params.opt = opt;
+
+    const int shift = c.bits - 8;
+    for (int i = 0; i < c.colors; ++i)
+        params.yuvColors.push_back({ (static_cast<uint64_t>((i * 8 + 16) << shift) << (2 * c.bits)) | (static_cast<uint64_t>((i * 5 + 64) << shift) << c.bits) | static_cast<uint64_t>((192 - i * 3) << shift) });
+
+    const TColorMaskCore<T> core(params);
+
+    double best = 1e30;
+    for (int rep = 0; rep < 5; ++rep)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < iterations; ++i)
+            core.process(dst.data(), Y.data(), U.data(), V.data(), width, width, width_uv);
+
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations);
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    const int iterations = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 20;
+    const int opt = (argc > 2) ? std::atoi(argv[2]) : -1;
+
+    try
+    {
+        for (const BenchCase& c : cases)
+        {
+            const double ms = (c.bits == 8) ? run<uint8_t>(c, iterations, opt) : run<uint16_t>(c, iterations, opt);
+            std::printf("%-40s %8.3f ms\n", c.name, ms);
+        }
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,392 +1,385 @@
 #include <algorithm>
-#include <future>
-#include <limits>
-#include <regex>
+#include <stdexcept>
 
 #include "tcolormask.h"
-#include "VCL2/instrset.h"
 
 
-static AVS_FORCEINLINE int depfree_round(float d)
+template <typename T, bool grayscale>
+TColorMask<T, grayscale>::TColorMask(PClip child, TColorMaskParams params, bool forceMatrix, bool onlyY, int cache, bool delta, bool alpha, bool copyChroma, IScriptEnvironment* env)
+    : GenericVideoFilter(child), alpha_(alpha), copy_chroma_(copyChroma), cache_(cache), prev_core_(nullptr), prev_n_(-1), delta_(delta), v8(true)
 {
-    return static_cast<int>(d + 0.5f);
-}
-
-template <typename T, int subsamplingX, int subsamplingY>
-static void processLut(T* __restrict pDstY, const T* pSrcY, const T* pSrcV, const T* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, std::vector<T>& lutY, std::vector<T>& lutU, std::vector<T>& lutV) noexcept
-{
-    for (int y = 0; y < height; ++y)
+    if (cache < 0)
+        env->ThrowError("tcolormask: cache must be greater than or equal to 0.");
+
+    const bool rgb = vi.IsPlanarRGB() || vi.IsPlanarRGBA();
+    yuy2_ = vi.IsYUY2();
+
+    if (!vi.Is444() && !vi.Is420() && !vi.Is422() && !rgb)
+        env->ThrowError("tcolormask: only YUV420, YUV422, YUV444, YUY2 and planar RGB are supported!");
+    if (rgb && grayscale)
+        env->ThrowError("tcolormask: gray cannot be used with RGB clips.");
+    if (yuy2_ && delta)
+        env->ThrowError("tcolormask: delta cannot be used with YUY2 clips.");
+    if (alpha && (yuy2_ || onlyY || grayscale))
+        env->ThrowError("tcolormask: output=\"alpha\" cannot be used with YUY2 clips, onlyY and gray.");
+    if (copyChroma && (alpha || rgb || yuy2_ || onlyY || grayscale))
+        env->ThrowError("tcolormask: chroma=\"copy\" cannot be used with output=\"alpha\", RGB and YUY2 clips, onlyY and gray.");
+
+    params.width = vi.width;
+    params.height = vi.height;
+    params.subsamplingX = (rgb) ? 1 : (yuy2_) ? 2 : 1 << vi.GetPlaneWidthSubsampling(PLANAR_U);
+    params.subsamplingY = (rgb || yuy2_) ? 1 : 1 << vi.GetPlaneHeightSubsampling(PLANAR_U);
+    params.rgb = rgb;
+
+    planes_ = (rgb) ? rgb_planes : yuv_planes;
+
+    try { engines_ = std::make_unique<TColorMaskEngines<T>>(params, forceMatrix); }
+    catch (const std::exception& e) { env->ThrowError("%s", e.what()); }
+
+    groups_ = engines_->groups();
+
+    // fill=false: the clip is cropped to the region of interest.
+    if (!params.roiFill)
     {
-        for (int x = 0; x < width; ++x)
-            pDstY[x] = lutY[pSrcY[x]] & lutU[pSrcU[x / subsamplingX]] & lutV[pSrcV[x / subsamplingX]];
-
-
-        pSrcY += srcPitchY;
+        if (alpha || copyChroma)
+            env->ThrowError("tcolormask: fill=false cannot be used with output=\"alpha\" and chroma=\"copy\".");
 
-        if (y % subsamplingY == (subsamplingY - 1))
-        {
-            pSrcU += srcPitchUV;
-            pSrcV += srcPitchUV;
-        }
-
-        pDstY += dstPitchY;
+        const TColorMaskCore<T>& core = *engines_->get(-1, -1)[0];
+        vi.width = core.roiWidth();
+        vi.height = core.roiHeight();
     }
-}
 
-template <typename T, int subsamplingX, int subsamplingY>
-void processC(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<T>>& colors, int tolerance, int halftolerance) noexcept
-{
-    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
-    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
-    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
-    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+    try { env->CheckVersion(8); }
+    catch (const AvisynthError&) { v8 = false; };
 
-    constexpr int peak = std::numeric_limits<T>::max();
+    // Convert the colors for the matrix/range of the first frame up front.
+    if (v8)
+        engine(child->GetFrame(0, env), env);
 
-    for (int y = 0; y < height; ++y)
+    // The source with the mask as alpha plane.
+    if (alpha_)
     {
-        for (int x = 0; x < width; ++x)
-        {
-            T result_y = 0;
-            T result_u = 0;
-            T result_v = 0;
-
-            const T srcY_v = pSrcY[x];
-            T srcU_v, srcV_v;
+        if (groups_ > 1)
+            env->ThrowError("tcolormask: output=\"alpha\" cannot be used with several color groups.");
+
+        if (rgb)
+            vi.pixel_type = (sizeof(T) == 1) ? VideoInfo::CS_RGBAP : VideoInfo::CS_RGBAP16;
+        else if (vi.Is420())
+            vi.pixel_type = (sizeof(T) == 1) ? VideoInfo::CS_YUVA420 : VideoInfo::CS_YUVA420P16;
+        else if (vi.Is422())
+            vi.pixel_type = (sizeof(T) == 1) ? VideoInfo::CS_YUVA422 : VideoInfo::CS_YUVA422P16;
+        else
+            vi.pixel_type = (sizeof(T) == 1) ? VideoInfo::CS_YUVA444 : VideoInfo::CS_YUVA444P16;
 
-            if constexpr (subsamplingX == 2)
-            {
-                srcU_v = pSrcU[x / subsamplingX];
-                srcV_v = pSrcV[x / subsamplingX];
-            }
-            else
-            {
-                srcU_v = pSrcU[x];
-                srcV_v = pSrcV[x];
-            }
+        out_planes_ = alpha_planes;
+    }
+    // Several color groups: one full size plane per group.
+    else if (groups_ > 1)
+    {
+        if (onlyY || grayscale || copyChroma)
+            env->ThrowError("tcolormask: onlyY, gray and chroma=\"copy\" cannot be used with several color groups.");
 
-            for (auto& color : colors)
-            {
-                /* absolute difference */
-                const int diff_y = std::abs(srcY_v - color.Y);
-                const int diff_u = std::abs(srcU_v - color.U);
-                const int diff_v = std::abs(srcV_v - color.V);
-                /* comparing to tolerance */
-                const int diff_tolerance_min_y = std::max(diff_y, tolerance);
-                const int diff_tolerance_min_u = std::max(diff_u, halftolerance);
-                const int diff_tolerance_min_v = std::max(diff_v, halftolerance);
-
-                const int passed_y = (diff_y >= diff_tolerance_min_y) ? 0 : peak;
-                const int passed_u = (diff_u >= diff_tolerance_min_u) ? 0 : peak;
-                const int passed_v = (diff_v >= diff_tolerance_min_v) ? 0 : peak;
-
-                result_y = result_y | passed_y;
-                result_u = result_u | passed_u;
-                result_v = result_v | passed_v;
-            }
+        if (rgb)
+            vi.pixel_type = (sizeof(T) == 1) ? VideoInfo::CS_RGBP : VideoInfo::CS_RGBP16;
+        else
+            vi.pixel_type = (sizeof(T) == 1) ? VideoInfo::CS_YV24 : VideoInfo::CS_YUV444P16;
 
-            result_y = result_y & result_u;
-            pDstY[x] = result_y & result_v;
-        }
+        out_planes_ = planes_;
+    }
+    else
+        out_planes_ = yuv_planes;
 
-        pSrcY += srcPitchY;
+    // The mask of RGB clips is returned as Y.
+    if (rgb && groups_ == 1 && !alpha_)
+        vi.pixel_type = (sizeof(T) == 1) ? VideoInfo::CS_Y8 : VideoInfo::CS_Y16;
+    // The mask of YUY2 clips is returned as planar 4:2:2.
+    else if (yuy2_ && groups_ == 1)
+        vi.pixel_type = VideoInfo::CS_YV16;
 
-        if (y % subsamplingY == (subsamplingY - 1))
-        {
-            pSrcU += srcPitchUV;
-            pSrcV += srcPitchUV;
-        }
+    if (onlyY)
+        vi.pixel_type = (sizeof(T) == 1) ? VideoInfo::CS_Y8 : VideoInfo::CS_Y16;
+}
 
-        pDstY += dstPitchY;
-    }
+template <typename T>
+static YUVPlanes<T> planes(const PVideoFrame& frame, const int* ids) noexcept
+{
+    return { reinterpret_cast<const T*>(frame->GetReadPtr(ids[0])),
+        reinterpret_cast<const T*>(frame->GetReadPtr(ids[1])),
+        reinterpret_cast<const T*>(frame->GetReadPtr(ids[2])),
+        static_cast<int>(frame->GetPitch(ids[0]) / sizeof(T)),
+        static_cast<int>(frame->GetPitch(ids[1]) / sizeof(T)) };
 }
 
-template <typename T, bool grayscale, bool mt>
-TColorMask<T, grayscale, mt>::TColorMask(PClip child, std::vector<uint64_t> colors, int tolerance, bool bt601, int lutthr, bool onlyY, int opt, IScriptEnvironment* env)
-    : GenericVideoFilter(child), tolerance_(tolerance), v8(true)
+template <typename T, bool grayscale>
+const TColorMaskCore<T>* const* TColorMask<T, grayscale>::engine(const PVideoFrame& src, IScriptEnvironment* env)
 {
-    const int peak = (sizeof(T) == 1) ? 255 : 65535;
-    if (tolerance_ == -1)
-        tolerance_ = (sizeof(T) == 1) ? 10 : 2570;
-    if (tolerance_ < 0 || tolerance_ > peak)
-        env->ThrowError("tcolormask: tolerance must be between 0..%s", std::to_string(peak).c_str());
-
-    if (opt < -1 || opt > 3)
-        env->ThrowError("tcolormask: opt must be between -1..3.");
-
-    const int iset{ instrset_detect() };
-    if (opt == 1 && iset < 2)
-        env->ThrowError("tcolormask: opt=1 requires SSE2.");
-    if (opt == 2 && iset < 8)
-        env->ThrowError("tcolormask: opt=2 requires AVX2.");
-    if (opt == 3 && iset < 10)
-        env->ThrowError("tcolormask: opt=3 requires AVX512F.");
-
-    if (vi.Is444())
-    {
-        subsamplingY_ = 1;
-        subsamplingX_ = 1;
-        proc_lut = processLut<T, 1, 1>;
-
-        if ((opt == -1 && iset >= 10) || opt == 3)
-            p_ = processAvx512<T, 1, 1>;
-        else if ((opt == -1 && iset >= 8) || opt == 2)
-            p_ = processAvx2<T, 1, 1>;
-        else if ((opt == -1 && iset >= 2) || opt == 1)
-            p_ = processSse2<T, 1, 1>;
-        else
-            p_ = processC<T, 1, 1>;
-    }
-    else if (vi.Is420())
-    {
-        subsamplingY_ = 2;
-        subsamplingX_ = 2;
+    if (!v8)
+        return engines_->get(-1, -1);
 
-        if (mt && (vi.height / 2) % 2 != 0)
-            env->ThrowError("tcolormask: chroma height must be mod2 for mt=true!");
+    const AVSMap* props = env->getFramePropsRO(src);
+    int err;
+    int64_t matrix = env->propGetInt(props, "_Matrix", 0, &err);
+    if (err)
+        matrix = -1;
+    int64_t range = env->propGetInt(props, "_ColorRange", 0, &err);
+    if (err)
+        range = -1;
 
-        proc_lut = processLut<T, 2, 2>;
+    const TColorMaskCore<T>* const* cores = nullptr;
 
-        if ((opt == -1 && iset >= 10) || opt == 3)
-            p_ = processAvx512<T, 2, 2>;
-        else if ((opt == -1 && iset >= 8) || opt == 2)
-            p_ = processAvx2<T, 2, 2>;
-        else if ((opt == -1 && iset >= 2) || opt == 1)
-            p_ = processSse2<T, 2, 2>;
-        else
-            p_ = processC<T, 2, 2>;
-    }
-    else if (vi.Is422())
-    {
-        subsamplingY_ = 1;
-        subsamplingX_ = 2;
-        proc_lut = processLut<T, 2, 1>;
-
-        if ((opt == -1 && iset >= 10) || opt == 3)
-            p_ = processAvx512<T, 2, 1>;
-        else if ((opt == -1 && iset >= 8) || opt == 2)
-            p_ = processAvx2<T, 2, 1>;
-        else if ((opt == -1 && iset >= 2) || opt == 1)
-            p_ = processSse2<T, 2, 1>;
-        else
-            p_ = processC<T, 2, 1>;
-    }
-    else
-        env->ThrowError("tcolormask: only YUV420, YUV422 and YUV444 are supported!");
+    try { cores = engines_->get(static_cast<int>(matrix), static_cast<int>(range)); }
+    catch (const std::exception& e) { env->ThrowError("%s", e.what()); }
 
-    const float kR = bt601 ? 0.299f : 0.2126f;
-    const float kB = bt601 ? 0.114f : 0.0722f;
+    return cores;
+}
 
-    colors_.reserve(colors.size());
+template <typename T, bool grayscale>
+uint64_t TColorMask<T, grayscale>::hashFrame(const PVideoFrame& src, uint64_t seed) const noexcept
+{
+    uint64_t hash = seed;
 
-    if constexpr (std::is_same_v<T, uint8_t>)
-    {
-        for (auto color : colors)
-        {
-            YUVPixel<T> p;
-            memset(&p, 0, sizeof(p));
-            const float r = static_cast<float>((color & 0xFF0000) >> 16) / 255.0f;
-            const float g = static_cast<float>((color & 0xFF00) >> 8) / 255.0f;
-            const float b = static_cast<float>(color & 0xFF) / 255.0f;
-
-            const float y = kR * r + (1 - kR - kB) * g + kB * b;
-            p.U = 128 + depfree_round(112.0f * (b - y) / (1 - kB));
-            p.V = 128 + depfree_round(112.0f * (r - y) / (1 - kR));
-            p.Y = 16 + depfree_round(219.0f * y);
-
-            colors_.emplace_back(p);
-        }
-    }
-    else
+    if (yuy2_)
+        return hashPlane(src->GetReadPtr(), src->GetRowSize(), src->GetHeight(), src->GetPitch(), hash);
+
+    for (int i = 0; i < 3; ++i)
     {
-        for (auto color : colors)
-        {
-            YUVPixel<T> p;
-            memset(&p, 0, sizeof(p));
-            const float r = static_cast<float>((color & 0xFFFF00000000) >> 32) / 65535.0f;
-            const float g = static_cast<float>((color & 0xFFFF0000) >> 16) / 65535.0f;
-            const float b = static_cast<float>(color & 0xFFFF) / 65535.0f;
-
-            const float y = kR * r + (1 - kR - kB) * g + kB * b;
-            p.U = 32768 + depfree_round(28672.0f * (b - y) / (1 - kB));
-            p.V = 32768 + depfree_round(28672.0f * (r - y) / (1 - kR));
-            p.Y = 4096 + depfree_round(56064.0f * y);
-
-            colors_.emplace_back(p);
-        }
+        const int plane = planes_[i];
+        hash = hashPlane(src->GetReadPtr(plane), src->GetRowSize(plane), src->GetHeight(plane), src->GetPitch(plane), hash);
     }
 
-    if (colors_.size() > lutthr)
-        proc = (vi.width % 16) ? &TColorMask::process<true, true> : &TColorMask::process<true, false>;
-    else
-        proc = (vi.width % 16) ? &TColorMask::process<false, true> : &TColorMask::process<false, false>;
-
-    if (((vi.width % 16) != 0) || (colors_.size() > lutthr))
-        buildLuts();
+    return hash;
+}
 
-    try { env->CheckVersion(8); }
-    catch (const AvisynthError&) { v8 = false; };
+template <typename T, bool grayscale>
+PVideoFrame TColorMask<T, grayscale>::reuseFrame(const PVideoFrame& cached, const PVideoFrame& src, IScriptEnvironment* env) const
+{
+    if (!v8)
+        return cached;
+
+    // A subframe shares the mask buffer but has its own frame properties.
+    PVideoFrame dst;
+    const BYTE* ptr = cached->GetReadPtr(PLANAR_Y);
+
+    if (vi.IsY())
+        dst = env->Subframe(cached, 0, cached->GetPitch(PLANAR_Y), cached->GetRowSize(PLANAR_Y), cached->GetHeight(PLANAR_Y));
+    else if (alpha_)
+        dst = env->SubframePlanarA(cached, 0, cached->GetPitch(PLANAR_Y), cached->GetRowSize(PLANAR_Y), cached->GetHeight(PLANAR_Y),
+            static_cast<int>(cached->GetReadPtr(PLANAR_U) - ptr), static_cast<int>(cached->GetReadPtr(PLANAR_V) - ptr), cached->GetPitch(PLANAR_U),
+            static_cast<int>(cached->GetReadPtr(PLANAR_A) - ptr));
+    else
+        dst = env->SubframePlanar(cached, 0, cached->GetPitch(PLANAR_Y), cached->GetRowSize(PLANAR_Y), cached->GetHeight(PLANAR_Y),
+            static_cast<int>(cached->GetReadPtr(PLANAR_U) - ptr), static_cast<int>(cached->GetReadPtr(PLANAR_V) - ptr), cached->GetPitch(PLANAR_U));
 
-    vi1 = vi;
+    env->copyFrameProps(src, dst);
 
-    if (onlyY)
-        vi.pixel_type = (sizeof(T) == 1) ? VideoInfo::CS_Y8 : VideoInfo::CS_Y16;
+    return dst;
 }
 
-template <typename T, bool grayscale, bool mt>
-void TColorMask<T, grayscale, mt>::buildLuts() noexcept
+template <typename T, bool grayscale>
+PVideoFrame TColorMask<T, grayscale>::GetFrame(int n, IScriptEnvironment* env)
 {
-    constexpr int peak = std::numeric_limits<T>::max();
-    const int range_max = peak + 1;
-    lut_y.reserve(range_max);
-    lut_u.reserve(range_max);
-    lut_v.reserve(range_max);
+    PVideoFrame src = child->GetFrame(n, env);
+    const TColorMaskCore<T>* const* cores = engine(src, env);
+    // The first group identifies the engines of the frame.
+    const TColorMaskCore<T>& core = *cores[0];
 
-    for (int i = 0; i < range_max; ++i)
+    uint64_t hash = 0;
+
+    if (cache_)
     {
-        T val_y = 0;
-        T val_u = 0;
-        T val_v = 0;
+        // Masks of different engines must not be mixed up.
+        hash = hashFrame(src, reinterpret_cast<uintptr_t>(&core));
+
+        std::lock_guard<std::mutex> lock(cache_mutex_);
 
-        for (auto& color : colors_)
+        for (auto it = cache_frames_.begin(); it != cache_frames_.end(); ++it)
         {
-            val_y |= ((abs(i - color.Y) < tolerance_) ? peak : 0);
-            val_u |= ((abs(i - color.U) < (tolerance_ / 2)) ? peak : 0);
-            val_v |= ((abs(i - color.V) < (tolerance_ / 2)) ? peak : 0);
+            if (it->first == hash)
+            {
+                cache_frames_.splice(cache_frames_.begin(), cache_frames_, it);
+                return reuseFrame(it->second, src, env);
+            }
         }
+    }
 
-        lut_y.emplace_back(val_y);
-        lut_u.emplace_back(val_u);
-        lut_v.emplace_back(val_v);
+    // onlyY: only the mask plane is allocated.
+    PVideoFrame dst = (v8) ? env->NewVideoFrameP(vi, &src) : env->NewVideoFrame(vi);
+
+    T* dst_ptrs[3];
+    int dst_pitches[3];
+
+    for (int i = 0; i < groups_; ++i)
+    {
+        const int plane = out_planes_[i];
+        dst_ptrs[i] = reinterpret_cast<T*>(dst->GetWritePtr(plane));
+        dst_pitches[i] = dst->GetPitch(plane) / sizeof(T);
     }
-}
 
-template <typename T, bool grayscale, bool mt>
-PVideoFrame TColorMask<T, grayscale, mt>::GetFrame(int n, IScriptEnvironment* env)
-{
-    PVideoFrame src = child->GetFrame(n, env);
-    PVideoFrame dst = (v8) ? env->NewVideoFrameP(vi1, &src) : env->NewVideoFrame(vi1);
+    if (yuy2_)
+    {
+        const PackedPlanes<T> src_packed = { reinterpret_cast<const T*>(src->GetReadPtr()), nullptr, static_cast<int>(src->GetPitch() / sizeof(T)), 0 };
+        TColorMaskCore<T>::processPacked(cores, groups_, dst_ptrs, dst_pitches, src_packed);
+    }
+    else if (delta_)
+    {
+        PVideoFrame prev_src;
+        PVideoFrame prev_dst;
 
-    const int width = src->GetRowSize(PLANAR_Y) / sizeof(T);
-    const int height = src->GetHeight(PLANAR_Y);
+        {
+            std::lock_guard<std::mutex> lock(delta_mutex_);
 
-    const T* srcY_ptr = reinterpret_cast<const T*>(src->GetReadPtr(PLANAR_Y));
-    const T* srcU_ptr = reinterpret_cast<const T*>(src->GetReadPtr(PLANAR_U));
-    const T* srcV_ptr = reinterpret_cast<const T*>(src->GetReadPtr(PLANAR_V));
-    const int src_pitch_y = src->GetPitch(PLANAR_Y) / sizeof(T);
-    const int src_pitch_uv = src->GetPitch(PLANAR_U) / sizeof(T);
+            // Only sequential access with the same engine can reuse the previous mask.
+            if (prev_n_ == n - 1 && prev_core_ == &core)
+            {
+                prev_src = prev_src_;
+                prev_dst = prev_dst_;
+            }
+        }
 
-    T* __restrict dstY_ptr = reinterpret_cast<T*>(dst->GetWritePtr(PLANAR_Y));
-    const int dst_pitch_y = dst->GetPitch(PLANAR_Y) / sizeof(T);
+        const YUVPlanes<T> src_planes = planes<T>(src, planes_);
 
-    if constexpr (mt)
-    {
-        //async seems to be threadpool'ed on windows, creating threads is less efficient
-        auto thread2 = std::async(std::launch::async, [=] {
-            (this->*proc)(dstY_ptr,
-                srcY_ptr,
-                srcV_ptr,
-                srcU_ptr,
-                dst_pitch_y,
-                src_pitch_y,
-                src_pitch_uv,
-                width,
-                height / 2);
-            });
-        (this->*proc)(dstY_ptr + (dst_pitch_y * height / 2),
-            srcY_ptr + (src_pitch_y * height / 2),
-            srcV_ptr + (src_pitch_uv * height / (2 * subsamplingY_)),
-            srcU_ptr + (src_pitch_uv * height / (2 * subsamplingY_)),
-            dst_pitch_y,
-            src_pitch_y,
-            src_pitch_uv,
-            width,
-            height / 2);
-        thread2.wait();
+        if (prev_dst)
+        {
+            for (int i = 0; i < groups_; ++i)
+            {
+                const int plane = out_planes_[i];
+                cores[i]->processDelta(dst_ptrs[i], dst_pitches[i], src_planes, reinterpret_cast<const T*>(prev_dst->GetReadPtr(plane)), prev_dst->GetPitch(plane) / sizeof(T), planes<T>(prev_src, planes_));
+            }
+        }
+        else
+            TColorMaskCore<T>::processGroups(cores, groups_, dst_ptrs, dst_pitches, src_planes);
+
+        std::lock_guard<std::mutex> lock(delta_mutex_);
+
+        prev_n_ = n;
+        prev_src_ = src;
+        prev_dst_ = dst;
+        prev_core_ = &core;
     }
     else
-        (this->*proc)(dstY_ptr, srcY_ptr, srcV_ptr, srcU_ptr, dst_pitch_y, src_pitch_y, src_pitch_uv, width, height);
+        TColorMaskCore<T>::processGroups(cores, groups_, dst_ptrs, dst_pitches, planes<T>(src, planes_));
 
-    if constexpr (grayscale)
+    // AviSynth+ frames cannot share planes, the source planes are copied next to the mask.
+    if (alpha_)
     {
-        memset(dst->GetWritePtr(PLANAR_U), 128, dst->GetPitch(PLANAR_U) * dst->GetHeight(PLANAR_U));
-        memset(dst->GetWritePtr(PLANAR_V), 128, dst->GetPitch(PLANAR_V) * dst->GetHeight(PLANAR_V));
+        for (int i = 0; i < 3; ++i)
+        {
+            const int plane = planes_[i];
+            env->BitBlt(dst->GetWritePtr(plane), dst->GetPitch(plane), src->GetReadPtr(plane), src->GetPitch(plane), src->GetRowSize(plane), src->GetHeight(plane));
+        }
     }
 
-    return dst;
-}
-
-template <typename T, bool grayscale, bool mt>
-template <bool cs, bool border>
-void TColorMask<T, grayscale, mt>::process(T* __restrict dstY_ptr, const T* srcY_ptr, const T* srcV_ptr, const T* srcU_ptr, int dst_pitch_y, int src_pitch_y, int src_pitch_uv, int width, int height) noexcept
-{
-    if constexpr (cs)
+    // There is no plane sharing between AviSynth+ frames, the chroma is copied.
+    if (copy_chroma_)
     {
-        proc_lut(dstY_ptr, srcY_ptr, srcV_ptr, srcU_ptr, dst_pitch_y, src_pitch_y, src_pitch_uv, width, height, lut_y, lut_u, lut_v);
-        return;
+        env->BitBlt(dst->GetWritePtr(PLANAR_U), dst->GetPitch(PLANAR_U), src->GetReadPtr(PLANAR_U), src->GetPitch(PLANAR_U), src->GetRowSize(PLANAR_U), src->GetHeight(PLANAR_U));
+        env->BitBlt(dst->GetWritePtr(PLANAR_V), dst->GetPitch(PLANAR_V), src->GetReadPtr(PLANAR_V), src->GetPitch(PLANAR_V), src->GetRowSize(PLANAR_V), src->GetHeight(PLANAR_V));
     }
 
-    p_(dstY_ptr, srcY_ptr, srcV_ptr, srcU_ptr, dst_pitch_y, src_pitch_y, src_pitch_uv, width - border, height, colors_, tolerance_, tolerance_ / 2);
+    if (groups_ == 2)
+        memset(dst->GetWritePtr(out_planes_[2]), 0, dst->GetPitch(out_planes_[2]) * dst->GetHeight(out_planes_[2]));
 
-    if constexpr (border != 0)
+    if constexpr (grayscale)
     {
-        proc_lut(dstY_ptr + width - border,
-            srcY_ptr + width - border,
-            srcV_ptr + (width - border) / subsamplingX_,
-            srcU_ptr + (width - border) / subsamplingX_,
-            dst_pitch_y, src_pitch_y, src_pitch_uv, border, height, lut_y, lut_u, lut_v);
+        memset(dst->GetWritePtr(PLANAR_U), 128, dst->GetPitch(PLANAR_U) * dst->GetHeight(PLANAR_U));
+        memset(dst->GetWritePtr(PLANAR_V), 128, dst->GetPitch(PLANAR_V) * dst->GetHeight(PLANAR_V));
     }
-}
 
-static uint64_t avisynthStringToInt(const std::string& str) noexcept
-{
-    if (str[0] == '$')
+    if (cache_)
     {
-        auto substr = str.substr(1, str.length());
-        return strtoll(substr.c_str(), 0, 16);
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+
+        if (std::none_of(cache_frames_.begin(), cache_frames_.end(), [hash](const auto& entry) { return entry.first == hash; }))
+        {
+            cache_frames_.emplace_front(hash, dst);
+            if (cache_frames_.size() > cache_)
+                cache_frames_.pop_back();
+        }
     }
 
-    return strtoll(str.c_str(), 0, 10);
+    return dst;
 }
 
 AVSValue __cdecl CreateTColorMask(AVSValue args, void*, IScriptEnvironment* env)
 {
-    enum { CLIP, COLORS, TOLERANCE, BT601, GRAYSCALE, LUTTHR, MT, ONLYy, OPT };
+    enum { CLIP, COLORS, TOLERANCE, BT601, GRAYSCALE, LUTTHR, MT, ONLYy, OPT, CACHE, DELTA, LEFT, TOP, WIDTH, HEIGHT, FILL, COLORFILE, YUVCOLORS, SPACE, METRIC, WY, WU, WV, SOFT, MODE, OUTPUT, CHROMA, STREAM };
 
     PClip clip = args[CLIP].AsClip();
     const int bits = clip->GetVideoInfo().BitsPerComponent();
 
     if (bits != 8 && bits != 16)
         env->ThrowError("tcolormask: only 8 and 16-bit supported.");
-    if (!clip->GetVideoInfo().IsPlanar())
-        env->ThrowError("tcolormask: only planar format supported.");
-
-    std::string str = args[COLORS].AsString("");
-
-    std::regex e("(/\\*.*\\*/|//.*$)");   //comments
-    str = std::regex_replace(str, e, "");
+    if (!clip->GetVideoInfo().IsPlanar() && !clip->GetVideoInfo().IsYUY2())
+        env->ThrowError("tcolormask: only planar and YUY2 formats supported.");
 
-    std::vector<uint64_t> colors;
-    std::regex rgx("(\\$?[\\da-fA-F]+)");
+    TColorMaskParams params;
+    bool alpha = false;
+    bool copyChroma = false;
 
-    std::sregex_token_iterator iter(str.cbegin(), str.cend(), rgx, 1);
-    std::sregex_token_iterator end;
-    for (; iter != end; ++iter)
+    try
     {
-        if (bits == 16 && iter->str().size() < 12)
-            env->ThrowError("tcolormask: wrong hex color for 16-bit.");
+        const std::string space = args[SPACE].AsString("rgb");
+        if (space != "rgb" && space != "yuv")
+            throw std::runtime_error("tcolormask: space must be rgb or yuv.");
 
-        try {
-            colors.emplace_back(avisynthStringToInt(iter->str()));
-        }
-        catch (...) {
-            env->ThrowError("tcolormask: parsing error.");
+        // space="yuv": colors and colorfile are already Y/U/V triplets.
+        std::vector<TColorMaskColor>& colors = (space == "yuv") ? params.yuvColors : params.colors;
+        parseColors(args[COLORS].AsString(""), bits, colors);
+
+        if (args[COLORFILE].Defined())
+        {
+            const auto palette = loadPalette(args[COLORFILE].AsString(), bits);
+            colors.insert(colors.end(), palette->begin(), palette->end());
         }
+
+        parseColors(args[YUVCOLORS].AsString(""), bits, params.yuvColors);
+
+        const std::string metric = args[METRIC].AsString("box");
+        if (metric != "box" && metric != "euclid")
+            throw std::runtime_error("tcolormask: metric must be box or euclid.");
+
+        params.euclid = metric == "euclid";
+
+        const std::string mode = args[MODE].AsString("mask");
+        if (mode != "mask" && mode != "index")
+            throw std::runtime_error("tcolormask: mode must be mask or index.");
+
+        params.index = mode == "index";
+
+        const std::string output = args[OUTPUT].AsString("mask");
+        if (output != "mask" && output != "alpha")
+            throw std::runtime_error("tcolormask: output must be mask or alpha.");
+
+        alpha = output == "alpha";
+
+        const std::string chroma = args[CHROMA].AsString("none");
+        if (chroma != "none" && chroma != "copy")
+            throw std::runtime_error("tcolormask: chroma must be none or copy.");
+
+        copyChroma = chroma == "copy";
     }
+    catch (const std::exception& e) { env->ThrowError("%s", e.what()); }
+
+    params.tolerance = args[TOLERANCE].AsInt(-1);
+    params.matrix = (args[BT601].AsBool(false)) ? 6 : 1;
+    params.lutthr = args[LUTTHR].AsInt(9);
+    params.mt = args[MT].AsBool(false);
+    params.opt = args[OPT].AsInt(-1);
+    params.stream = args[STREAM].AsInt(-1);
+    params.roiLeft = args[LEFT].AsInt(0);
+    params.roiTop = args[TOP].AsInt(0);
+    params.roiWidth = args[WIDTH].AsInt(0);
+    params.roiHeight = args[HEIGHT].AsInt(0);
+    params.roiFill = args[FILL].AsBool(true);
+    params.weightY = args[WY].AsInt(1);
+    params.weightU = args[WU].AsInt(4);
+    params.weightV = args[WV].AsInt(4);
+    params.soft = args[SOFT].AsBool(false);
 
     const bool grayscale = args[GRAYSCALE].AsBool(false);
-    const bool mt = args[MT].AsBool(false);
     const bool y = args[ONLYy].AsBool(false);
+    const int cache = args[CACHE].AsInt(0);
+    const bool delta = args[DELTA].AsBool(false);
 
     if (grayscale && y)
         env->ThrowError("tcolormask: both grayscale and onlyY cannot be true in the same time.");
@@ -394,36 +387,16 @@ AVSValue __cdecl CreateTColorMask(AVSValue args, void*, IScriptEnvironment* env)
     if (bits == 8)
     {
         if (!grayscale)
-        {
-            if (!mt)
-                return new TColorMask<uint8_t, false, false>(clip, colors, args[TOLERANCE].AsInt(-1), args[BT601].AsBool(false), args[LUTTHR].AsInt(9), y, args[OPT].AsInt(-1), env);
-            else
-                return new TColorMask<uint8_t, false, true>(clip, colors, args[TOLERANCE].AsInt(-1), args[BT601].AsBool(false), args[LUTTHR].AsInt(9), y, args[OPT].AsInt(-1), env);
-        }
+            return new TColorMask<uint8_t, false>(clip, std::move(params), args[BT601].Defined(), y, cache, delta, alpha, copyChroma, env);
         else
-        {
-            if (!mt)
-                return new TColorMask<uint8_t, true, false>(clip, colors, args[TOLERANCE].AsInt(-1), args[BT601].AsBool(false), args[LUTTHR].AsInt(9), y, args[OPT].AsInt(-1), env);
-            else
-                return new TColorMask<uint8_t, true, true>(clip, colors, args[TOLERANCE].AsInt(-1), args[BT601].AsBool(false), args[LUTTHR].AsInt(9), y, args[OPT].AsInt(-1), env);
-        }
+            return new TColorMask<uint8_t, true>(clip, std::move(params), args[BT601].Defined(), y, cache, delta, alpha, copyChroma, env);
     }
     else
     {
         if (!grayscale)
-        {
-            if (!mt)
-                return new TColorMask<uint16_t, false, false>(clip, colors, args[TOLERANCE].AsInt(-1), args[BT601].AsBool(false), args[LUTTHR].AsInt(9), y, args[OPT].AsInt(-1), env);
-            else
-                return new TColorMask<uint16_t, false, true>(clip, colors, args[TOLERANCE].AsInt(-1), args[BT601].AsBool(false), args[LUTTHR].AsInt(9), y, args[OPT].AsInt(-1), env);
-        }
+            return new TColorMask<uint16_t, false>(clip, std::move(params), args[BT601].Defined(), y, cache, delta, alpha, copyChroma, env);
         else
-        {
-            if (!mt)
-                return new TColorMask<uint16_t, true, false>(clip, colors, args[TOLERANCE].AsInt(-1), args[BT601].AsBool(false), args[LUTTHR].AsInt(9), y, args[OPT].AsInt(-1), env);
-            else
-                return new TColorMask<uint16_t, true, true>(clip, colors, args[TOLERANCE].AsInt(-1), args[BT601].AsBool(false), args[LUTTHR].AsInt(9), y, args[OPT].AsInt(-1), env);
-        }
+            return new TColorMask<uint16_t, true>(clip, std::move(params), args[BT601].Defined(), y, cache, delta, alpha, copyChroma, env);
     }
 }
 
@@ -432,6 +405,6 @@ const AVS_Linkage* AVS_linkage = nullptr;
 extern "C" __declspec(dllexport) const char* __stdcall AvisynthPluginInit3(IScriptEnvironment * env, const AVS_Linkage* const vectors) {
     AVS_linkage = vectors;
 
-    env->AddFunction("tcolormask", "c[colors]s[tolerance]i[bt601]b[gray]b[lutthr]i[mt]b[onlyY]b[opt]i", CreateTColorMask, 0);
+    env->AddFunction("tcolormask", "c[colors]s[tolerance]i[bt601]b[gray]b[lutthr]i[mt]b[onlyY]b[opt]i[cache]i[delta]b[left]i[top]i[width]i[height]i[fill]b[colorfile]s[yuvcolors]s[space]s[metric]s[wy]i[wu]i[wv]i[soft]b[mode]s[output]s[chroma]s[stream]i", CreateTColorMask, 0);
     return "Why are you looking at this?";
 }
@@ -1,22 +1,17 @@
 #pragma once
 
-#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
 
 #include "avisynth.h"
+#include "tcolormask_core.h"
 
-template <typename T>
-struct YUVPixel
-{
-    T Y;
-    T U;
-    T V;
-};
-
-template <typename T, bool grayscale, bool mt>
+template <typename T, bool grayscale>
 class TColorMask : public GenericVideoFilter
 {
 public:
-    TColorMask(PClip child, std::vector<uint64_t> colors, int tolerance, bool bt601, int lutthr, bool onlyY, int opt, IScriptEnvironment* env);
+    TColorMask(PClip child, TColorMaskParams params, bool forceMatrix, bool onlyY, int cache, bool delta, bool alpha, bool copyChroma, IScriptEnvironment* env);
     PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) override;
 
     int __stdcall SetCacheHints(int cachehints, int frame_range) override
@@ -25,32 +20,38 @@ public:
     }
 
 private:
-    void buildLuts() noexcept;
-
-    template <bool cs, bool border>
-    void process(T* __restrict dstY_ptr, const T* srcY_ptr, const T* srcV_ptr, const T* srcU_ptr, int dst_pitch_y, int src_pitch_y, int src_pitch_uv, int width, int height) noexcept;
-    void (TColorMask::* proc)(T* __restrict dstY_ptr, const T* srcY_ptr, const T* srcV_ptr, const T* srcU_ptr, int dst_pitch_y, int src_pitch_y, int src_pitch_uv, int width, int height) noexcept;
-
-    void(*proc_lut)(T* __restrict pDstY, const T* pSrcY, const T* pSrcV, const T* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, std::vector<T>& lutY, std::vector<T>& lutU, std::vector<T>& lutV) noexcept;
-    void(*p_)(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<T>>& colors, int tolerance, int halftolerance) noexcept;
-
-    std::vector<YUVPixel<T>> colors_;
-    int tolerance_;
-    int subsamplingY_;
-    int subsamplingX_;
-
-    std::vector<T> lut_y;
-    std::vector<T> lut_u;
-    std::vector<T> lut_v;
+    const TColorMaskCore<T>* const* engine(const PVideoFrame& src, IScriptEnvironment* env);
+    uint64_t hashFrame(const PVideoFrame& src, uint64_t seed) const noexcept;
+    PVideoFrame reuseFrame(const PVideoFrame& cached, const PVideoFrame& src, IScriptEnvironment* env) const;
+
+    static constexpr int yuv_planes[3] = { PLANAR_Y, PLANAR_U, PLANAR_V };
+    static constexpr int rgb_planes[3] = { PLANAR_R, PLANAR_G, PLANAR_B };
+    static constexpr int alpha_planes[1] = { PLANAR_A };
+
+    std::unique_ptr<TColorMaskEngines<T>> engines_;
+    int groups_;
+    // Source planes in the order of the engine (Y, U, V or R, G, B) and the planes of the groups in the output.
+    const int* planes_;
+    const int* out_planes_;
+    // Interleaved source, the mask is computed through TColorMaskCore::processPacked.
+    bool yuy2_;
+    // output="alpha": the source planes with the mask in the alpha plane.
+    bool alpha_;
+    // chroma="copy": the source chroma next to the mask.
+    bool copy_chroma_;
+
+    // Most recently used first.
+    std::list<std::pair<uint64_t, PVideoFrame>> cache_frames_;
+    std::mutex cache_mutex_;
+    size_t cache_;
+
+    // Last produced frame for delta processing.
+    PVideoFrame prev_src_;
+    PVideoFrame prev_dst_;
+    const TColorMaskCore<T>* prev_core_;
+    int prev_n_;
+    std::mutex delta_mutex_;
+    bool delta_;
 
     bool v8;
-
-    VideoInfo vi1;
 };
-
-template <typename T, int subsamplingX, int subsamplingY>
-void processSse2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<T>>& colors, int tolerance, int halftolerance) noexcept;
-template <typename T, int subsamplingX, int subsamplingY>
-void processAvx2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<T>>& colors, int tolerance, int halftolerance) noexcept;
-template <typename T, int subsamplingX, int subsamplingY>
-void processAvx512(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<T>>& colors, int tolerance, int halftolerance) noexcept;
@@ -1,13 +1,49 @@
-#include "tcolormask.h"
+#include "tcolormask_core.h"
 #include "VCL2/vectorclass.h"
 
-template <typename T, int subsamplingX, int subsamplingY>
-void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<T>>& colors, int tolerance, int halftolerance) noexcept
+// Non-temporal store of the mask, the rows must be 64-byte aligned.
+template <typename V, typename T>
+static inline void storeMask(const V& result, T* dst, bool stream) noexcept
+{
+    if (stream)
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(dst), result);
+    else
+        result.store(dst);
+}
+
+// Source of the next row, requested while the current one is masked.
+template <typename T>
+static inline void prefetchRow(const T* srcY, const T* srcU, const T* srcV) noexcept
+{
+    _mm_prefetch(reinterpret_cast<const char*>(srcY), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(srcU), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(srcV), _MM_HINT_T0);
+}
+
+// Chroma of 2x horizontally subsampled rows, doubled to the luma width. Only the half vector that is used is read.
+static inline Vec64uc loadChroma2x(const uint8_t* ptr) noexcept
+{
+    const Vec32uc v = Vec32uc().load(ptr);
+    return Vec64uc(blend32<0, 32, 1, 33, 2, 34, 3, 35, 4, 36, 5, 37, 6, 38, 7, 39, 8, 40, 9, 41, 10, 42, 11, 43, 12, 44, 13, 45, 14, 46, 15, 47>(v, v),
+        blend32<16, 48, 17, 49, 18, 50, 19, 51, 20, 52, 21, 53, 22, 54, 23, 55, 24, 56, 25, 57, 26, 58, 27, 59, 28, 60, 29, 61, 30, 62, 31, 63>(v, v));
+}
+
+static inline Vec32us loadChroma2x(const uint16_t* ptr) noexcept
+{
+    const Vec16us v = Vec16us().load(ptr);
+    return Vec32us(blend16<0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23>(v, v), blend16<8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31>(v, v));
+}
+
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
 {
     const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
     const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
     const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
     T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+    const bool stream = colors.stream && alignedRows(pDstY_, dstPitchY * sizeof(T), 64);
+    // Known at compile time for a few colors, so the color loop is unrolled with the colors in registers.
+    const size_t count = (colorCount) ? colorCount : colors.size();
 
     for (int y = 0; y < height; ++y)
     {
@@ -15,6 +51,9 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
         {
             for (int x = 0; x < width; x += 64)
             {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
                 Vec64uc result_y = zero_si512();
                 Vec64uc result_u = zero_si512();
                 Vec64uc result_v = zero_si512();
@@ -24,12 +63,8 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
 
                 if constexpr (subsamplingX == 2)
                 {
-                    srcU_v = Vec64uc().load(pSrcU + x / subsamplingX);
-                    srcU_v = blend64<0, 64, 1, 65, 2, 66, 3, 67, 4, 68, 5, 69, 6, 70, 7, 71, 8, 72, 9, 73, 10, 74, 11, 75, 12, 76, 13, 77, 14, 78, 15, 79,
-                        16, 80, 17, 81, 18, 82, 19, 83, 20, 84, 21, 85, 22, 86, 23, 87, 24, 88, 25, 89, 26, 90, 27, 91, 28, 92, 29, 93, 30, 94, 31, 95>(srcU_v, srcU_v);
-                    srcV_v = Vec64uc().load(pSrcV + x / subsamplingX);
-                    srcV_v = blend64<0, 64, 1, 65, 2, 66, 3, 67, 4, 68, 5, 69, 6, 70, 7, 71, 8, 72, 9, 73, 10, 74, 11, 75, 12, 76, 13, 77, 14, 78, 15, 79,
-                        16, 80, 17, 81, 18, 82, 19, 83, 20, 84, 21, 85, 22, 86, 23, 87, 24, 88, 25, 89, 26, 90, 27, 91, 28, 92, 29, 93, 30, 94, 31, 95>(srcV_v, srcV_v);
+                    srcU_v = loadChroma2x(pSrcU + x / subsamplingX);
+                    srcV_v = loadChroma2x(pSrcV + x / subsamplingX);
                 }
                 else
                 {
@@ -37,11 +72,11 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
                     srcV_v = Vec64uc().load(pSrcV + x);
                 }
 
-                for (auto& color : colors)
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const auto colorVector_y = Vec64uc(color.Y);
-                    const auto colorVector_u = Vec64uc(color.U);
-                    const auto colorVector_v = Vec64uc(color.V);
+                    const auto colorVector_y = Vec64uc(colors.Y[i]);
+                    const auto colorVector_u = Vec64uc(colors.U[i]);
+                    const auto colorVector_v = Vec64uc(colors.V[i]);
                     /* absolute difference */
                     const auto maximum_y = max(srcY_v, colorVector_y);
                     const auto maximum_u = max(srcU_v, colorVector_u);
@@ -55,9 +90,9 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
                     const auto diff_u = maximum_u - minimum_u;
                     const auto diff_v = maximum_v - minimum_v;
                     /* comparing to tolerance */
-                    const auto diff_tolerance_min_y = max(diff_y, Vec64uc(tolerance));
-                    const auto diff_tolerance_min_u = max(diff_u, Vec64uc(halftolerance));
-                    const auto diff_tolerance_min_v = max(diff_v, Vec64uc(halftolerance));
+                    const auto diff_tolerance_min_y = max(diff_y, Vec64uc(colors.tolY[i]));
+                    const auto diff_tolerance_min_u = max(diff_u, Vec64uc(colors.tolU[i]));
+                    const auto diff_tolerance_min_v = max(diff_v, Vec64uc(colors.tolV[i]));
 
                     const auto passed_y = select(diff_y >= diff_tolerance_min_y, zero_si512(), Vec64uc(255));
                     const auto passed_u = select(diff_u >= diff_tolerance_min_u, zero_si512(), Vec64uc(255));
@@ -70,13 +105,16 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
 
                 result_y = result_y & result_u;
                 result_y = result_y & result_v;
-                result_y.store(pDstY + x);
+                storeMask(result_y, pDstY + x, stream);
             }
         }
         else
         {
             for (int x = 0; x < width; x += 32)
             {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
                 Vec32us result_y = zero_si512();
                 Vec32us result_u = zero_si512();
                 Vec32us result_v = zero_si512();
@@ -86,10 +124,8 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
 
                 if constexpr (subsamplingX == 2)
                 {
-                    srcU_v = Vec32us().load(pSrcU + x / subsamplingX);
-                    srcU_v = blend32<0, 32, 1, 33, 2, 34, 3, 35, 4, 36, 5, 37, 6, 38, 7, 39, 8, 40, 9, 41, 10, 42, 11, 43, 12, 44, 13, 45, 14, 46, 15, 47>(srcU_v, srcU_v);
-                    srcV_v = Vec32us().load(pSrcV + x / subsamplingX);
-                    srcV_v = blend32<0, 32, 1, 33, 2, 34, 3, 35, 4, 36, 5, 37, 6, 38, 7, 39, 8, 40, 9, 41, 10, 42, 11, 43, 12, 44, 13, 45, 14, 46, 15, 47>(srcV_v, srcV_v);
+                    srcU_v = loadChroma2x(pSrcU + x / subsamplingX);
+                    srcV_v = loadChroma2x(pSrcV + x / subsamplingX);
                 }
                 else
                 {
@@ -97,11 +133,11 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
                     srcV_v = Vec32us().load(pSrcV + x);
                 }
 
-                for (auto& color : colors)
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const auto colorVector_y = Vec32us(color.Y);
-                    const auto colorVector_u = Vec32us(color.U);
-                    const auto colorVector_v = Vec32us(color.V);
+                    const auto colorVector_y = Vec32us(colors.Y[i]);
+                    const auto colorVector_u = Vec32us(colors.U[i]);
+                    const auto colorVector_v = Vec32us(colors.V[i]);
                     /* absolute difference */
                     const auto maximum_y = max(srcY_v, colorVector_y);
                     const auto maximum_u = max(srcU_v, colorVector_u);
@@ -115,9 +151,9 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
                     const auto diff_u = (maximum_u - minimum_u);
                     const auto diff_v = (maximum_v - minimum_v);
                     /* comparing to tolerance */
-                    const auto diff_tolerance_min_y = max(diff_y, Vec32us(tolerance));
-                    const auto diff_tolerance_min_u = max(diff_u, Vec32us(halftolerance));
-                    const auto diff_tolerance_min_v = max(diff_v, Vec32us(halftolerance));
+                    const auto diff_tolerance_min_y = max(diff_y, Vec32us(colors.tolY[i]));
+                    const auto diff_tolerance_min_u = max(diff_u, Vec32us(colors.tolU[i]));
+                    const auto diff_tolerance_min_v = max(diff_v, Vec32us(colors.tolV[i]));
 
                     const auto passed_y = select(diff_y >= diff_tolerance_min_y, zero_si512(), Vec32us(65535));
                     const auto passed_u = select(diff_u >= diff_tolerance_min_u, zero_si512(), Vec32us(65535));
@@ -130,8 +166,309 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
 
                 result_y = result_y & result_u;
                 result_y = result_y & result_v;
-                result_y.store(pDstY + x);
+                storeMask(result_y, pDstY + x, stream);
+            }
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+
+    if (stream)
+        _mm_sfence();
+}
+
+// 0xFF where wY * dY^2 + wU * dU^2 + wV * dV^2 < radius2. The unpacks and packs are lane local, so the pixel order is kept.
+static inline Vec64uc euclidPass(const Vec64uc& dy, const Vec64uc& du, const Vec64uc& dv, const Vec32s& wy, const Vec32s& wu, const Vec32s& wv, const Vec16i& radius2) noexcept
+{
+    const __m512i zero = _mm512_setzero_si512();
+
+    auto half = [&](__m512i y16, __m512i u16, __m512i v16)
+    {
+        const __m512i wy16 = _mm512_mullo_epi16(y16, wy);
+        const __m512i wu16 = _mm512_mullo_epi16(u16, wu);
+        const __m512i wv16 = _mm512_mullo_epi16(v16, wv);
+
+        const __m512i dist_lo = _mm512_add_epi32(_mm512_madd_epi16(_mm512_unpacklo_epi16(y16, u16), _mm512_unpacklo_epi16(wy16, wu16)),
+            _mm512_madd_epi16(_mm512_unpacklo_epi16(v16, zero), _mm512_unpacklo_epi16(wv16, zero)));
+        const __m512i dist_hi = _mm512_add_epi32(_mm512_madd_epi16(_mm512_unpackhi_epi16(y16, u16), _mm512_unpackhi_epi16(wy16, wu16)),
+            _mm512_madd_epi16(_mm512_unpackhi_epi16(v16, zero), _mm512_unpackhi_epi16(wv16, zero)));
+
+        return _mm512_packs_epi32(_mm512_movm_epi32(_mm512_cmpgt_epi32_mask(radius2, dist_lo)), _mm512_movm_epi32(_mm512_cmpgt_epi32_mask(radius2, dist_hi)));
+    };
+
+    return _mm512_packs_epi16(half(_mm512_unpacklo_epi8(dy, zero), _mm512_unpacklo_epi8(du, zero), _mm512_unpacklo_epi8(dv, zero)),
+        half(_mm512_unpackhi_epi8(dy, zero), _mm512_unpackhi_epi8(du, zero), _mm512_unpackhi_epi8(dv, zero)));
+}
+
+// 16-bit: the squares need 64 bits, even and odd 32-bit lanes are multiplied separately.
+static inline Vec32us euclidPass(const Vec32us& dy, const Vec32us& du, const Vec32us& dv, const Vec8uq& wy, const Vec8uq& wu, const Vec8uq& wv, const Vec8q& radius2) noexcept
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i low_dwords = _mm512_set_epi32(0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1);
+
+    auto square = [](__m512i d, __m512i w)
+    {
+        return _mm512_mul_epu32(_mm512_mul_epu32(d, d), w);
+    };
+
+    auto pass = [&](__m512i y32, __m512i u32, __m512i v32)
+    {
+        const __m512i dist_even = _mm512_add_epi64(_mm512_add_epi64(square(y32, wy), square(u32, wu)), square(v32, wv));
+        const __m512i dist_odd = _mm512_add_epi64(_mm512_add_epi64(square(_mm512_srli_epi64(y32, 32), wy), square(_mm512_srli_epi64(u32, 32), wu)), square(_mm512_srli_epi64(v32, 32), wv));
+        // dist - radius2 < 0, sign of the high dword copied to the whole qword.
+        const __m512i pass_even = _mm512_shuffle_epi32(_mm512_srai_epi32(_mm512_sub_epi64(dist_even, radius2), 31), static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(3, 3, 1, 1)));
+        const __m512i pass_odd = _mm512_shuffle_epi32(_mm512_srai_epi32(_mm512_sub_epi64(dist_odd, radius2), 31), static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(3, 3, 1, 1)));
+
+        return _mm512_or_si512(_mm512_and_si512(pass_even, low_dwords), _mm512_andnot_si512(low_dwords, pass_odd));
+    };
+
+    return _mm512_packs_epi32(pass(_mm512_unpacklo_epi16(dy, zero), _mm512_unpacklo_epi16(du, zero), _mm512_unpacklo_epi16(dv, zero)),
+        pass(_mm512_unpackhi_epi16(dy, zero), _mm512_unpackhi_epi16(du, zero), _mm512_unpackhi_epi16(dv, zero)));
+}
+
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processEuclidAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+    const bool stream = colors.stream && alignedRows(pDstY_, dstPitchY * sizeof(T), 64);
+    // Known at compile time for a few colors, so the color loop is unrolled with the colors in registers.
+    const size_t count = (colorCount) ? colorCount : colors.size();
+
+    for (int y = 0; y < height; ++y)
+    {
+        if constexpr (std::is_same_v<T, uint8_t>)
+        {
+            const Vec32s wy(colors.weightY);
+            const Vec32s wu(colors.weightU);
+            const Vec32s wv(colors.weightV);
+
+            for (int x = 0; x < width; x += 64)
+            {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+                Vec64uc result = zero_si512();
+
+                const auto srcY_v = Vec64uc().load(pSrcY + x);
+                Vec64uc srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = loadChroma2x(pSrcU + x / subsamplingX);
+                    srcV_v = loadChroma2x(pSrcV + x / subsamplingX);
+                }
+                else
+                {
+                    srcU_v = Vec64uc().load(pSrcU + x);
+                    srcV_v = Vec64uc().load(pSrcV + x);
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const auto colorVector_y = Vec64uc(colors.Y[i]);
+                    const auto colorVector_u = Vec64uc(colors.U[i]);
+                    const auto colorVector_v = Vec64uc(colors.V[i]);
+                    /* absolute difference */
+                    const auto diff_y = max(srcY_v, colorVector_y) - min(srcY_v, colorVector_y);
+                    const auto diff_u = max(srcU_v, colorVector_u) - min(srcU_v, colorVector_u);
+                    const auto diff_v = max(srcV_v, colorVector_v) - min(srcV_v, colorVector_v);
+
+                    result = result | euclidPass(diff_y, diff_u, diff_v, wy, wu, wv, Vec16i(static_cast<int>(colors.radius2[i])));
+                }
+
+                storeMask(result, pDstY + x, stream);
+            }
+        }
+        else
+        {
+            const Vec8uq wy(colors.weightY);
+            const Vec8uq wu(colors.weightU);
+            const Vec8uq wv(colors.weightV);
+
+            for (int x = 0; x < width; x += 32)
+            {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+                Vec32us result = zero_si512();
+
+                const auto srcY_v = Vec32us().load(pSrcY + x);
+                Vec32us srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = loadChroma2x(pSrcU + x / subsamplingX);
+                    srcV_v = loadChroma2x(pSrcV + x / subsamplingX);
+                }
+                else
+                {
+                    srcU_v = Vec32us().load(pSrcU + x);
+                    srcV_v = Vec32us().load(pSrcV + x);
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const auto colorVector_y = Vec32us(colors.Y[i]);
+                    const auto colorVector_u = Vec32us(colors.U[i]);
+                    const auto colorVector_v = Vec32us(colors.V[i]);
+                    /* absolute difference */
+                    const auto diff_y = max(srcY_v, colorVector_y) - min(srcY_v, colorVector_y);
+                    const auto diff_u = max(srcU_v, colorVector_u) - min(srcU_v, colorVector_u);
+                    const auto diff_v = max(srcV_v, colorVector_v) - min(srcV_v, colorVector_v);
+
+                    result = result | euclidPass(diff_y, diff_u, diff_v, wy, wu, wv, Vec8q(colors.radius2[i]));
+                }
+
+                storeMask(result, pDstY + x, stream);
+            }
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+
+    if (stream)
+        _mm_sfence();
+}
+
+// soft=true: (tolerance - difference) * peak / tolerance of the worst plane (or of the Euclidean distance), the best color wins.
+template <bool euclid>
+static inline Vec16f softPass(const Vec16f& srcY, const Vec16f& srcU, const Vec16f& srcV, const Vec16f& colorY, const Vec16f& colorU, const Vec16f& colorV,
+    const Vec16f& tolY, const Vec16f& tolU, const Vec16f& tolV, const Vec16f& scaleY, const Vec16f& scaleU, const Vec16f& scaleV, const Vec16f& wy, const Vec16f& wu, const Vec16f& wv) noexcept
+{
+    const auto diff_y = abs(srcY - colorY);
+    const auto diff_u = abs(srcU - colorU);
+    const auto diff_v = abs(srcV - colorV);
+
+    if constexpr (euclid)
+        return (tolY - sqrt(diff_y * diff_y * wy + diff_u * diff_u * wu + diff_v * diff_v * wv)) * scaleY;
+    else
+        return min(min((tolY - diff_y) * scaleY, (tolU - diff_u) * scaleU), (tolV - diff_v) * scaleV);
+}
+
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processSoftAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+    const bool stream = colors.stream && alignedRows(pDstY_, dstPitchY * sizeof(T), 64);
+
+    // Pixels per integer vector and the float vectors they are widened to.
+    constexpr int step = 64 / sizeof(T);
+    constexpr int parts = step / 16;
+    const Vec16f peak(static_cast<float>(std::numeric_limits<T>::max()));
+    const Vec16f wy(static_cast<float>(colors.weightY));
+    const Vec16f wu(static_cast<float>(colors.weightU));
+    const Vec16f wv(static_cast<float>(colors.weightV));
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; x += step)
+        {
+            if (stream)
+                prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+            Vec16f srcY_f[parts], srcU_f[parts], srcV_f[parts];
+            Vec16f value[parts];
+
+            if constexpr (std::is_same_v<T, uint8_t>)
+            {
+                const auto srcY_v = Vec64uc().load(pSrcY + x);
+                Vec64uc srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = loadChroma2x(pSrcU + x / subsamplingX);
+                    srcV_v = loadChroma2x(pSrcV + x / subsamplingX);
+                }
+                else
+                {
+                    srcU_v = Vec64uc().load(pSrcU + x);
+                    srcV_v = Vec64uc().load(pSrcV + x);
+                }
+
+                auto widen = [](const Vec64uc& v, Vec16f* out)
+                {
+                    const Vec32us lo = extend_low(v);
+                    const Vec32us hi = extend_high(v);
+                    out[0] = to_float(Vec16i(extend_low(lo)));
+                    out[1] = to_float(Vec16i(extend_high(lo)));
+                    out[2] = to_float(Vec16i(extend_low(hi)));
+                    out[3] = to_float(Vec16i(extend_high(hi)));
+                };
+
+                widen(srcY_v, srcY_f);
+                widen(srcU_v, srcU_f);
+                widen(srcV_v, srcV_f);
+            }
+            else
+            {
+                const auto srcY_v = Vec32us().load(pSrcY + x);
+                Vec32us srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = loadChroma2x(pSrcU + x / subsamplingX);
+                    srcV_v = loadChroma2x(pSrcV + x / subsamplingX);
+                }
+                else
+                {
+                    srcU_v = Vec32us().load(pSrcU + x);
+                    srcV_v = Vec32us().load(pSrcV + x);
+                }
+
+                auto widen = [](const Vec32us& v, Vec16f* out)
+                {
+                    out[0] = to_float(Vec16i(extend_low(v)));
+                    out[1] = to_float(Vec16i(extend_high(v)));
+                };
+
+                widen(srcY_v, srcY_f);
+                widen(srcU_v, srcU_f);
+                widen(srcV_v, srcV_f);
+            }
+
+            for (int p = 0; p < parts; ++p)
+                value[p] = Vec16f(0.0f);
+
+            for (size_t i = 0; i < colors.size(); ++i)
+            {
+                const Vec16f colorY(colors.Y[i]), colorU(colors.U[i]), colorV(colors.V[i]);
+                const Vec16f tolY(colors.tolY[i]), tolU(colors.tolU[i]), tolV(colors.tolV[i]);
+                const Vec16f scaleY(colors.scaleY[i]), scaleU(colors.scaleU[i]), scaleV(colors.scaleV[i]);
+
+                for (int p = 0; p < parts; ++p)
+                    value[p] = max(value[p], softPass<euclid>(srcY_f[p], srcU_f[p], srcV_f[p], colorY, colorU, colorV, tolY, tolU, tolV, scaleY, scaleU, scaleV, wy, wu, wv));
             }
+
+            // The values are in 0..peak, compress doesn't need to saturate.
+            if constexpr (std::is_same_v<T, uint8_t>)
+            {
+                storeMask(compress(compress(Vec16ui(roundi(min(value[0], peak))), Vec16ui(roundi(min(value[1], peak)))),
+                    compress(Vec16ui(roundi(min(value[2], peak))), Vec16ui(roundi(min(value[3], peak))))), pDstY + x, stream);
+            }
+            else
+                storeMask(compress(Vec16ui(roundi(min(value[0], peak))), Vec16ui(roundi(min(value[1], peak)))), pDstY + x, stream);
         }
 
         pSrcY += srcPitchY;
@@ -144,18 +481,342 @@ void processAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrc
 
         pDstY += dstPitchY;
     }
+
+    if (stream)
+        _mm_sfence();
 }
 
-template void processAvx512<uint8_t, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint8_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-template void processAvx512<uint8_t, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint8_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-template void processAvx512<uint8_t, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint8_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-
-template void processAvx512<uint16_t, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint16_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-template void processAvx512<uint16_t, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint16_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-template void processAvx512<uint16_t, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint16_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
+// mode=index: 1 + the index of the first color matching in every plane, 0 if none.
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processIndexAvx512(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+    const bool stream = colors.stream && alignedRows(pDstY_, dstPitchY * sizeof(T), 64);
+
+    for (int y = 0; y < height; ++y)
+    {
+        if constexpr (std::is_same_v<T, uint8_t>)
+        {
+            const Vec32s wy(colors.weightY);
+            const Vec32s wu(colors.weightU);
+            const Vec32s wv(colors.weightV);
+
+            for (int x = 0; x < width; x += 64)
+            {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+                Vec64uc result = zero_si512();
+
+                const auto srcY_v = Vec64uc().load(pSrcY + x);
+                Vec64uc srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = loadChroma2x(pSrcU + x / subsamplingX);
+                    srcV_v = loadChroma2x(pSrcV + x / subsamplingX);
+                }
+                else
+                {
+                    srcU_v = Vec64uc().load(pSrcU + x);
+                    srcV_v = Vec64uc().load(pSrcV + x);
+                }
+
+                // Backwards, so the first matching color is written last.
+                for (size_t i = colors.size(); i-- > 0;)
+                {
+                    const auto colorVector_y = Vec64uc(colors.Y[i]);
+                    const auto colorVector_u = Vec64uc(colors.U[i]);
+                    const auto colorVector_v = Vec64uc(colors.V[i]);
+                    /* absolute difference */
+                    const auto diff_y = max(srcY_v, colorVector_y) - min(srcY_v, colorVector_y);
+                    const auto diff_u = max(srcU_v, colorVector_u) - min(srcU_v, colorVector_u);
+                    const auto diff_v = max(srcV_v, colorVector_v) - min(srcV_v, colorVector_v);
+
+                    if constexpr (euclid)
+                    {
+                        const auto pass = euclidPass(diff_y, diff_u, diff_v, wy, wu, wv, Vec16i(static_cast<int>(colors.radius2[i])));
+                        result = (pass & Vec64uc(static_cast<T>(i + 1))) | (result & ~pass);
+                    }
+                    else
+                        result = select((diff_y < Vec64uc(colors.tolY[i])) & (diff_u < Vec64uc(colors.tolU[i])) & (diff_v < Vec64uc(colors.tolV[i])), Vec64uc(static_cast<T>(i + 1)), result);
+                }
+
+                storeMask(result, pDstY + x, stream);
+            }
+        }
+        else
+        {
+            const Vec8uq wy(colors.weightY);
+            const Vec8uq wu(colors.weightU);
+            const Vec8uq wv(colors.weightV);
+
+            for (int x = 0; x < width; x += 32)
+            {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+                Vec32us result = zero_si512();
+
+                const auto srcY_v = Vec32us().load(pSrcY + x);
+                Vec32us srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = loadChroma2x(pSrcU + x / subsamplingX);
+                    srcV_v = loadChroma2x(pSrcV + x / subsamplingX);
+                }
+                else
+                {
+                    srcU_v = Vec32us().load(pSrcU + x);
+                    srcV_v = Vec32us().load(pSrcV + x);
+                }
+
+                // Backwards, so the first matching color is written last.
+                for (size_t i = colors.size(); i-- > 0;)
+                {
+                    const auto colorVector_y = Vec32us(colors.Y[i]);
+                    const auto colorVector_u = Vec32us(colors.U[i]);
+                    const auto colorVector_v = Vec32us(colors.V[i]);
+                    /* absolute difference */
+                    const auto diff_y = max(srcY_v, colorVector_y) - min(srcY_v, colorVector_y);
+                    const auto diff_u = max(srcU_v, colorVector_u) - min(srcU_v, colorVector_u);
+                    const auto diff_v = max(srcV_v, colorVector_v) - min(srcV_v, colorVector_v);
+
+                    if constexpr (euclid)
+                    {
+                        const auto pass = euclidPass(diff_y, diff_u, diff_v, wy, wu, wv, Vec8q(colors.radius2[i]));
+                        result = (pass & Vec32us(static_cast<T>(i + 1))) | (result & ~pass);
+                    }
+                    else
+                        result = select((diff_y < Vec32us(colors.tolY[i])) & (diff_u < Vec32us(colors.tolU[i])) & (diff_v < Vec32us(colors.tolV[i])), Vec32us(static_cast<T>(i + 1)), result);
+                }
+
+                storeMask(result, pDstY + x, stream);
+            }
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+
+    if (stream)
+        _mm_sfence();
+}
+
+
+// processPacked(): count U V pairs of a row to the U and V planes.
+// The even samples are packed with truncation, the odd ones after a shift by the sample size.
+template <typename T>
+void deinterleaveUVAvx512(T* __restrict dstU, T* __restrict dstV, const T* src, int count) noexcept
+{
+    using V = std::conditional_t<std::is_same_v<T, uint8_t>, Vec32us, Vec16ui>;
+    constexpr int step = 64 / sizeof(T);
+    constexpr int shift = sizeof(T) * 8;
+    int x = 0;
+
+    for (; x + step <= count; x += step)
+    {
+        const V a = V().load(src + x * 2);
+        const V b = V().load(src + x * 2 + step);
+
+        compress(a, b).store(dstU + x);
+        compress(a >> shift, b >> shift).store(dstV + x);
+    }
+
+    for (; x < count; ++x)
+    {
+        dstU[x] = src[x * 2];
+        dstV[x] = src[x * 2 + 1];
+    }
+}
+
+// processPacked(): count Y0 U Y1 V groups of a row to the Y, U and V planes.
+// The even bytes are the luma, the odd ones U V pairs deinterleaved again.
+void deinterleaveYUY2Avx512(uint8_t* __restrict dstY, uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept
+{
+    constexpr int step = 64;
+    int x = 0;
+
+    for (; x + step <= count; x += step)
+    {
+        const Vec32us a = Vec32us().load(src + x * 4);
+        const Vec32us b = Vec32us().load(src + x * 4 + step);
+        const Vec32us c = Vec32us().load(src + x * 4 + step * 2);
+        const Vec32us d = Vec32us().load(src + x * 4 + step * 3);
+
+        compress(a, b).store(dstY + x * 2);
+        compress(c, d).store(dstY + x * 2 + step);
+
+        const Vec32us uv0 = __m512i(compress(a >> 8, b >> 8));
+        const Vec32us uv1 = __m512i(compress(c >> 8, d >> 8));
+
+        compress(uv0, uv1).store(dstU + x);
+        compress(uv0 >> 8, uv1 >> 8).store(dstV + x);
+    }
+
+    for (; x < count; ++x)
+    {
+        dstY[x * 2] = src[x * 4];
+        dstU[x] = src[x * 4 + 1];
+        dstY[x * 2 + 1] = src[x * 4 + 2];
+        dstV[x] = src[x * 4 + 3];
+    }
+}
+
+template void processAvx512<uint8_t, 1, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 1, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 1, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 1, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 1, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 1, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 1, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 1, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 1, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 2, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 2, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 2, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 2, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 2, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 2, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 2, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processAvx512<uint8_t, 2, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processAvx512<uint16_t, 1, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 1, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 1, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 1, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 1, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 1, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 1, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 1, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 1, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 2, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 2, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 2, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 2, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 2, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 2, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 2, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processAvx512<uint16_t, 2, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processEuclidAvx512<uint8_t, 1, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 1, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 1, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 1, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 1, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 1, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 1, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 1, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 1, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 2, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 2, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 2, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 2, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 2, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 2, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 2, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidAvx512<uint8_t, 2, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processEuclidAvx512<uint16_t, 1, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 1, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 1, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 1, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 1, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 1, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 1, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 1, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 1, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 2, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 2, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 2, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 2, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 2, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 2, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 2, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidAvx512<uint16_t, 2, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processSoftAvx512<uint8_t, 1, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSoftAvx512<uint8_t, 2, 2, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSoftAvx512<uint8_t, 2, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processSoftAvx512<uint8_t, 1, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSoftAvx512<uint8_t, 2, 2, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSoftAvx512<uint8_t, 2, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processSoftAvx512<uint16_t, 1, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSoftAvx512<uint16_t, 2, 2, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSoftAvx512<uint16_t, 2, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processSoftAvx512<uint16_t, 1, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSoftAvx512<uint16_t, 2, 2, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSoftAvx512<uint16_t, 2, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processIndexAvx512<uint8_t, 1, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processIndexAvx512<uint8_t, 2, 2, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processIndexAvx512<uint8_t, 2, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processIndexAvx512<uint8_t, 1, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processIndexAvx512<uint8_t, 2, 2, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processIndexAvx512<uint8_t, 2, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processIndexAvx512<uint16_t, 1, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processIndexAvx512<uint16_t, 2, 2, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processIndexAvx512<uint16_t, 2, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processIndexAvx512<uint16_t, 1, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processIndexAvx512<uint16_t, 2, 2, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processIndexAvx512<uint16_t, 2, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void deinterleaveUVAvx512<uint8_t>(uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept;
+template void deinterleaveUVAvx512<uint16_t>(uint16_t* __restrict dstU, uint16_t* __restrict dstV, const uint16_t* src, int count) noexcept;
@@ -0,0 +1,1521 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "tcolormask_core.h"
+#include "VCL2/instrset.h"
+
+static inline int depfree_round(float d)
+{
+    return static_cast<int>(d + 0.5f);
+}
+
+template <typename T, int subsamplingX, int subsamplingY>
+static void processLut(T* __restrict pDstY, const T* pSrcY, const T* pSrcV, const T* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const TColorMaskContext<T>& ctx) noexcept
+{
+    const T* lutY = ctx.lutY;
+    const T* lutU = ctx.lutU;
+    const T* lutV = ctx.lutV;
+
+    // 4:2:0: the chroma lookups are shared by the two luma rows.
+    for (int y = 0; y < height; y += subsamplingY)
+    {
+        const bool pair = subsamplingY == 2 && y + 1 < height;
+
+        for (int x = 0; x < width; ++x)
+        {
+            const T uv = lutU[pSrcU[x / subsamplingX]] & lutV[pSrcV[x / subsamplingX]];
+
+            pDstY[x] = lutY[pSrcY[x]] & uv;
+            if (pair)
+                pDstY[x + dstPitchY] = lutY[pSrcY[x + srcPitchY]] & uv;
+        }
+
+        pSrcY += srcPitchY * subsamplingY;
+        pSrcU += srcPitchUV;
+        pSrcV += srcPitchUV;
+        pDstY += dstPitchY * subsamplingY;
+    }
+}
+
+template <typename T, int subsamplingX, int subsamplingY>
+void processC(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+
+    constexpr int peak = std::numeric_limits<T>::max();
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            T result_y = 0;
+            T result_u = 0;
+            T result_v = 0;
+
+            const T srcY_v = pSrcY[x];
+            T srcU_v, srcV_v;
+
+            if constexpr (subsamplingX == 2)
+            {
+                srcU_v = pSrcU[x / subsamplingX];
+                srcV_v = pSrcV[x / subsamplingX];
+            }
+            else
+            {
+                srcU_v = pSrcU[x];
+                srcV_v = pSrcV[x];
+            }
+
+            for (size_t i = 0; i < colors.size(); ++i)
+            {
+                /* absolute difference */
+                const int diff_y = std::abs(srcY_v - colors.Y[i]);
+                const int diff_u = std::abs(srcU_v - colors.U[i]);
+                const int diff_v = std::abs(srcV_v - colors.V[i]);
+                /* comparing to tolerance */
+                const int diff_tolerance_min_y = std::max(diff_y, static_cast<int>(colors.tolY[i]));
+                const int diff_tolerance_min_u = std::max(diff_u, static_cast<int>(colors.tolU[i]));
+                const int diff_tolerance_min_v = std::max(diff_v, static_cast<int>(colors.tolV[i]));
+
+                const int passed_y = (diff_y >= diff_tolerance_min_y) ? 0 : peak;
+                const int passed_u = (diff_u >= diff_tolerance_min_u) ? 0 : peak;
+                const int passed_v = (diff_v >= diff_tolerance_min_v) ? 0 : peak;
+
+                result_y = result_y | passed_y;
+                result_u = result_u | passed_u;
+                result_v = result_v | passed_v;
+            }
+
+            result_y = result_y & result_u;
+            pDstY[x] = result_y & result_v;
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+}
+
+template <typename T, int subsamplingX, int subsamplingY>
+void processEuclidC(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+
+    constexpr int peak = std::numeric_limits<T>::max();
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const int srcY_v = pSrcY[x];
+            const int srcU_v = pSrcU[x / subsamplingX];
+            const int srcV_v = pSrcV[x / subsamplingX];
+
+            T result = 0;
+
+            for (size_t i = 0; i < colors.size(); ++i)
+            {
+                const int64_t diff_y = srcY_v - colors.Y[i];
+                const int64_t diff_u = srcU_v - colors.U[i];
+                const int64_t diff_v = srcV_v - colors.V[i];
+
+                if (colors.weightY * diff_y * diff_y + colors.weightU * diff_u * diff_u + colors.weightV * diff_v * diff_v < colors.radius2[i])
+                {
+                    result = peak;
+                    break;
+                }
+            }
+
+            pDstY[x] = result;
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+}
+
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processSoftC(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+
+    constexpr float peak = std::numeric_limits<T>::max();
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const float srcY_v = pSrcY[x];
+            const float srcU_v = pSrcU[x / subsamplingX];
+            const float srcV_v = pSrcV[x / subsamplingX];
+
+            float value = 0.0f;
+
+            for (size_t i = 0; i < colors.size(); ++i)
+            {
+                const float diff_y = std::abs(srcY_v - colors.Y[i]);
+                const float diff_u = std::abs(srcU_v - colors.U[i]);
+                const float diff_v = std::abs(srcV_v - colors.V[i]);
+
+                if constexpr (euclid)
+                {
+                    const float dist = std::sqrt(diff_y * diff_y * colors.weightY + diff_u * diff_u * colors.weightU + diff_v * diff_v * colors.weightV);
+                    value = std::max(value, (colors.tolY[i] - dist) * colors.scaleY[i]);
+                }
+                else
+                {
+                    value = std::max(value, std::min(std::min((colors.tolY[i] - diff_y) * colors.scaleY[i], (colors.tolU[i] - diff_u) * colors.scaleU[i]),
+                        (colors.tolV[i] - diff_v) * colors.scaleV[i]));
+                }
+            }
+
+            pDstY[x] = static_cast<T>(std::nearbyint(std::min(value, peak)));
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+}
+
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processIndexC(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const int srcY_v = pSrcY[x];
+            const int srcU_v = pSrcU[x / subsamplingX];
+            const int srcV_v = pSrcV[x / subsamplingX];
+
+            T result = 0;
+
+            for (size_t i = 0; i < colors.size(); ++i)
+            {
+                const int64_t diff_y = std::abs(srcY_v - colors.Y[i]);
+                const int64_t diff_u = std::abs(srcU_v - colors.U[i]);
+                const int64_t diff_v = std::abs(srcV_v - colors.V[i]);
+
+                bool passed;
+
+                if constexpr (euclid)
+                    passed = colors.weightY * diff_y * diff_y + colors.weightU * diff_u * diff_u + colors.weightV * diff_v * diff_v < colors.radius2[i];
+                else
+                    passed = diff_y < colors.tolY[i] && diff_u < colors.tolU[i] && diff_v < colors.tolV[i];
+
+                if (passed)
+                {
+                    result = static_cast<T>(i + 1);
+                    break;
+                }
+            }
+
+            pDstY[x] = result;
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+}
+
+// metric=euclid, 8-bit: lut has one bit per Y/U/V triplet.
+template <typename T, int subsamplingX, int subsamplingY>
+static void processLut3d(T* __restrict pDstY, const T* pSrcY, const T* pSrcV, const T* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const TColorMaskContext<T>& ctx) noexcept
+{
+    const uint8_t* lut = ctx.lut3d;
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const int index = (pSrcY[x] << 16) | (pSrcU[x / subsamplingX] << 8) | pSrcV[x / subsamplingX];
+            pDstY[x] = -((lut[index >> 3] >> (index & 7)) & 1);
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+}
+
+// Size of the largest cache reported by CPUID (deterministic cache parameters), 0 if unknown.
+static size_t lastLevelCacheSize() noexcept
+{
+    int regs[4];
+    cpuid(regs, 0);
+    // "AuthenticAMD" reports the same layout in leaf 0x8000001D.
+    const bool amd = regs[1] == 0x68747541 && regs[3] == 0x69746E65 && regs[2] == 0x444D4163;
+    const int leaf = (amd) ? 0x8000001D : 4;
+
+    cpuid(regs, leaf & 0x80000000);
+    if (static_cast<unsigned>(regs[0]) < static_cast<unsigned>(leaf))
+        return 0;
+
+    size_t size = 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        cpuid(regs, leaf, i);
+        if ((regs[0] & 31) == 0)
+            break;
+
+        const size_t ways = ((static_cast<unsigned>(regs[1]) >> 22) & 1023) + 1;
+        const size_t partitions = ((regs[1] >> 12) & 1023) + 1;
+        const size_t line = (regs[1] & 4095) + 1;
+        const size_t sets = static_cast<unsigned>(regs[2]) + 1ull;
+        size = std::max(size, ways * partitions * line * sets);
+    }
+
+    return size;
+}
+
+template <typename F, int... N>
+static auto unrolledKernel(size_t count, F kernel, std::integer_sequence<int, N...>) noexcept
+{
+    const decltype(kernel(std::integral_constant<int, 0>())) kernels[]{ kernel(std::integral_constant<int, N>())... };
+    return kernels[(count < sizeof...(N)) ? count : 0];
+}
+
+// kernel(std::integral_constant<int, colorCount>) returns the kernel specialized for colorCount colors.
+template <typename F>
+static auto unrolled(size_t count, F kernel) noexcept
+{
+    return unrolledKernel(count, kernel, std::make_integer_sequence<int, max_unrolled_colors + 1>());
+}
+
+// kernel masks the full vectors, kernel_c the rows narrower than one vector.
+// border: width isn't a multiple of the vector size, the last columns are masked again by a vector ending at the right edge
+// so nothing outside the region of interest is written.
+template <typename T, auto kernel, auto kernel_c, bool border>
+static void runKernel(T* __restrict pDstY, const T* pSrcY, const T* pSrcV, const T* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const TColorMaskContext<T>& ctx) noexcept
+{
+    if constexpr (border)
+    {
+        const int step = ctx.step;
+
+        if (width < step)
+        {
+            kernel_c(pDstY, pSrcY, pSrcV, pSrcU, dstPitchY, srcPitchY, srcPitchUV, width, height, *ctx.colors);
+            return;
+        }
+
+        const int tail = width % step;
+        kernel(pDstY, pSrcY, pSrcV, pSrcU, dstPitchY, srcPitchY, srcPitchUV, width - tail, height, *ctx.colors);
+
+        if (tail)
+        {
+            // The overlapped columns are written again with the same values.
+            // step is even and width is aligned to the subsampling, so the chroma offset is exact.
+            const int x = width - step;
+            const int x_uv = x / ctx.subsamplingX;
+
+            kernel(pDstY + x, pSrcY + x, pSrcV + x_uv, pSrcU + x_uv, dstPitchY, srcPitchY, srcPitchUV, step, height, *ctx.colors);
+        }
+    }
+    else
+        kernel(pDstY, pSrcY, pSrcV, pSrcU, dstPitchY, srcPitchY, srcPitchUV, width, height, *ctx.colors);
+}
+
+template <typename T, auto kernel, auto kernel_c>
+static auto kernelRun(bool border) noexcept
+{
+    return (border) ? runKernel<T, kernel, kernel_c, true> : runKernel<T, kernel, kernel_c, false>;
+}
+
+// Best kernels of the CPU, detected once: 0 C, 1 SSE2, 2 AVX2, 3 AVX-512, 4 AVX-512 VBMI.
+static int cpuLevel() noexcept
+{
+    static const int level = []
+    {
+        const int iset = instrset_detect();
+
+        if (iset >= 10)
+            return (hasAVX512VBMI()) ? 4 : 3;
+        if (iset >= 8)
+            return 2;
+        if (iset >= 2)
+            return 1;
+        return 0;
+    }();
+
+    return level;
+}
+
+static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+void AlignedArena::allocate(size_t size, bool hugePages)
+{
+#ifdef _WIN32
+    // Large pages need SeLockMemoryPrivilege.
+    static_cast<void>(hugePages);
+    data_.reset(static_cast<uint8_t*>(_aligned_malloc(std::max<size_t>(size, 64), 64)));
+#else
+    // Aligned to the huge page size, so that the whole block can be backed by them.
+    const size_t alignment = (hugePages) ? huge_page_size : 64;
+    size = (std::max<size_t>(size, 1) + alignment - 1) & ~(alignment - 1);
+    data_.reset(static_cast<uint8_t*>(std::aligned_alloc(alignment, size)));
+#ifdef MADV_HUGEPAGE
+    if (data_ && hugePages)
+        madvise(data_.get(), size, MADV_HUGEPAGE);
+#endif
+#endif
+
+    if (!data_)
+        throw std::bad_alloc();
+}
+
+void AlignedArena::Free::operator()(uint8_t* ptr) const noexcept
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+// processPacked() deinterleave of the C kernels.
+template <typename T>
+static void deinterleaveUVC(T* __restrict dstU, T* __restrict dstV, const T* src, int count) noexcept
+{
+    for (int x = 0; x < count; ++x)
+    {
+        dstU[x] = src[x * 2];
+        dstV[x] = src[x * 2 + 1];
+    }
+}
+
+// Y0 U Y1 V
+template <typename T>
+static void deinterleaveYUY2C(T* __restrict dstY, T* __restrict dstU, T* __restrict dstV, const T* src, int count) noexcept
+{
+    for (int x = 0; x < count; ++x)
+    {
+        dstY[x * 2] = src[x * 4];
+        dstU[x] = src[x * 4 + 1];
+        dstY[x * 2 + 1] = src[x * 4 + 2];
+        dstV[x] = src[x * 4 + 3];
+    }
+}
+
+// Rows masked by every group before moving on, small enough for the source rows to stay in L2.
+static constexpr int group_stripe = 16;
+
+// Row pitch of the processPacked() scratch, rows start on a cache line.
+static inline int scratchPitch(int width) noexcept
+{
+    return (width + 63) & ~63;
+}
+
+// Elements of the processPacked() scratch of one worker: a stripe of U and V, then of Y for packed 4:2:2.
+static inline size_t scratchSize(int width, int subsamplingX, int subsamplingY) noexcept
+{
+    return static_cast<size_t>(scratchPitch(width)) * group_stripe + static_cast<size_t>(scratchPitch(width / subsamplingX)) * (group_stripe / subsamplingY) * 2;
+}
+
+template <typename T>
+template <int subsamplingX, int subsamplingY>
+void TColorMaskCore<T>::setKernels(int isa, bool border, bool lut, const TColorMaskParams& params) noexcept
+{
+    const bool euclid = params.euclid;
+
+    if (lut)
+    {
+        ctx_.run = (euclid) ? processLut3d<T, subsamplingX, subsamplingY> : processLut<T, subsamplingX, subsamplingY>;
+        if constexpr (sizeof(T) == 1)
+        {
+            if (isa >= 4 && !euclid)
+                ctx_.run = processLutVbmi<subsamplingX, subsamplingY>;
+        }
+        return;
+    }
+
+    if (params.soft)
+    {
+        if (euclid)
+            setSoftKernels<subsamplingX, subsamplingY, true>(isa, border);
+        else
+            setSoftKernels<subsamplingX, subsamplingY, false>(isa, border);
+        return;
+    }
+
+    if (params.index)
+    {
+        if (euclid)
+            setIndexKernels<subsamplingX, subsamplingY, true>(isa, border);
+        else
+            setIndexKernels<subsamplingX, subsamplingY, false>(isa, border);
+        return;
+    }
+
+    const size_t count = colors_.size();
+
+    if (isa >= 3)
+    {
+        ctx_.run = (euclid) ? unrolled(count, [border](auto n) { return kernelRun<T, processEuclidAvx512<T, subsamplingX, subsamplingY, decltype(n)::value>, processEuclidC<T, subsamplingX, subsamplingY>>(border); })
+            : unrolled(count, [border](auto n) { return kernelRun<T, processAvx512<T, subsamplingX, subsamplingY, decltype(n)::value>, processC<T, subsamplingX, subsamplingY>>(border); });
+    }
+    else if (isa == 2)
+    {
+        ctx_.run = (euclid) ? unrolled(count, [border](auto n) { return kernelRun<T, processEuclidAvx2<T, subsamplingX, subsamplingY, decltype(n)::value>, processEuclidC<T, subsamplingX, subsamplingY>>(border); })
+            : unrolled(count, [border](auto n) { return kernelRun<T, processAvx2<T, subsamplingX, subsamplingY, decltype(n)::value>, processC<T, subsamplingX, subsamplingY>>(border); });
+    }
+    else if (isa == 1)
+    {
+        ctx_.run = (euclid) ? unrolled(count, [border](auto n) { return kernelRun<T, processEuclidSse2<T, subsamplingX, subsamplingY, decltype(n)::value>, processEuclidC<T, subsamplingX, subsamplingY>>(border); })
+            : unrolled(count, [border](auto n) { return kernelRun<T, processSse2<T, subsamplingX, subsamplingY, decltype(n)::value>, processC<T, subsamplingX, subsamplingY>>(border); });
+    }
+    else
+    {
+        ctx_.run = (euclid) ? kernelRun<T, processEuclidC<T, subsamplingX, subsamplingY>, processEuclidC<T, subsamplingX, subsamplingY>>(false)
+            : kernelRun<T, processC<T, subsamplingX, subsamplingY>, processC<T, subsamplingX, subsamplingY>>(false);
+    }
+}
+
+template <typename T>
+template <int subsamplingX, int subsamplingY, bool euclid>
+void TColorMaskCore<T>::setSoftKernels(int isa, bool border) noexcept
+{
+    constexpr auto kernel_c = processSoftC<T, subsamplingX, subsamplingY, euclid>;
+
+    if (isa >= 3)
+        ctx_.run = kernelRun<T, processSoftAvx512<T, subsamplingX, subsamplingY, euclid>, kernel_c>(border);
+    else if (isa == 2)
+        ctx_.run = kernelRun<T, processSoftAvx2<T, subsamplingX, subsamplingY, euclid>, kernel_c>(border);
+    else if (isa == 1)
+        ctx_.run = kernelRun<T, processSoftSse2<T, subsamplingX, subsamplingY, euclid>, kernel_c>(border);
+    else
+        ctx_.run = kernelRun<T, kernel_c, kernel_c>(false);
+}
+
+template <typename T>
+template <int subsamplingX, int subsamplingY, bool euclid>
+void TColorMaskCore<T>::setIndexKernels(int isa, bool border) noexcept
+{
+    constexpr auto kernel_c = processIndexC<T, subsamplingX, subsamplingY, euclid>;
+
+    if (isa >= 3)
+        ctx_.run = kernelRun<T, processIndexAvx512<T, subsamplingX, subsamplingY, euclid>, kernel_c>(border);
+    else if (isa == 2)
+        ctx_.run = kernelRun<T, processIndexAvx2<T, subsamplingX, subsamplingY, euclid>, kernel_c>(border);
+    else if (isa == 1)
+        ctx_.run = kernelRun<T, processIndexSse2<T, subsamplingX, subsamplingY, euclid>, kernel_c>(border);
+    else
+        ctx_.run = kernelRun<T, kernel_c, kernel_c>(false);
+}
+
+template <typename T>
+TColorMaskCore<T>::TColorMaskCore(const TColorMaskParams& params)
+    : width_(params.width), height_(params.height), roi_left_(params.roiLeft), roi_top_(params.roiTop), roi_width_(params.roiWidth), roi_height_(params.roiHeight),
+    subsamplingY_(params.subsamplingY), subsamplingX_(params.subsamplingX), mt_(params.mt), roi_fill_(params.roiFill)
+{
+    const int peak = (sizeof(T) == 1) ? 255 : 65535;
+    const int tolerance = (params.tolerance == -1) ? ((sizeof(T) == 1) ? 10 : 2570) : params.tolerance;
+    if (tolerance < 0 || tolerance > peak)
+        throw std::runtime_error("tcolormask: tolerance must be between 0.." + std::to_string(peak));
+
+    const int opt = params.opt;
+    if (opt < -1 || opt > 4)
+        throw std::runtime_error("tcolormask: opt must be between -1..4.");
+    if (params.stream < -1 || params.stream > 1)
+        throw std::runtime_error("tcolormask: stream must be between -1..1.");
+
+    static constexpr const char* isa_names[]{ "C", "SSE2", "AVX2", "AVX512F", "AVX512VBMI" };
+    if (opt > cpuLevel())
+        throw std::runtime_error("tcolormask: opt=" + std::to_string(opt) + " requires " + isa_names[opt] + ".");
+
+    const int isa = (opt == -1) ? cpuLevel() : opt;
+
+    if (width_ <= 0 || height_ <= 0)
+        throw std::runtime_error("tcolormask: width and height must be positive.");
+
+    // Crop style: non-positive width/height are relative to the right/bottom edge.
+    if (roi_width_ <= 0)
+        roi_width_ += width_ - roi_left_;
+    if (roi_height_ <= 0)
+        roi_height_ += height_ - roi_top_;
+
+    if (roi_left_ < 0 || roi_top_ < 0 || roi_width_ <= 0 || roi_height_ <= 0 || roi_left_ + roi_width_ > width_ || roi_top_ + roi_height_ > height_)
+        throw std::runtime_error("tcolormask: the region of interest must be inside the frame.");
+    if (roi_left_ % params.subsamplingX || roi_width_ % params.subsamplingX || roi_top_ % params.subsamplingY || roi_height_ % params.subsamplingY)
+        throw std::runtime_error("tcolormask: the region of interest must be aligned to the chroma subsampling.");
+
+    if (params.weightY < 0 || params.weightY > 128 || params.weightU < 0 || params.weightU > 128 || params.weightV < 0 || params.weightV > 128)
+        throw std::runtime_error("tcolormask: weights must be between 0..128.");
+
+    if (params.soft && params.index)
+        throw std::runtime_error("tcolormask: soft and mode=\"index\" cannot be used in the same time.");
+    if (params.index && params.colors.size() + params.yuvColors.size() > static_cast<size_t>(peak))
+        throw std::runtime_error("tcolormask: mode=\"index\" supports up to " + std::to_string(peak) + " colors.");
+
+    // Pixels per kernel iteration.
+    if (isa >= 3)
+        ctx_.step = 64 / sizeof(T);
+    else if (isa == 2)
+        ctx_.step = 32 / sizeof(T);
+    else if (isa == 1)
+        ctx_.step = 16 / sizeof(T);
+    else
+        ctx_.step = 1;
+
+    ctx_.deinterleaveUV = (isa >= 3) ? deinterleaveUVAvx512<T> : (isa == 2) ? deinterleaveUVAvx2<T> : (isa == 1) ? deinterleaveUVSse2<T> : deinterleaveUVC<T>;
+    ctx_.deinterleaveYUY2 = deinterleaveYUY2C<T>;
+
+    if constexpr (std::is_same_v<T, uint8_t>)
+    {
+        if (isa == 4)
+            ctx_.deinterleaveUV = deinterleaveUVVbmi;
+
+        ctx_.deinterleaveYUY2 = (isa == 4) ? deinterleaveYUY2Vbmi : (isa == 3) ? deinterleaveYUY2Avx512 : (isa == 2) ? deinterleaveYUY2Avx2 : (isa == 1) ? deinterleaveYUY2Sse2 : deinterleaveYUY2C<T>;
+    }
+
+    float kR;
+    float kB;
+
+    switch (params.matrix)
+    {
+        case 1: kR = 0.2126f; kB = 0.0722f; break;
+        case 4: kR = 0.3f; kB = 0.11f; break;
+        case 5:
+        case 6: kR = 0.299f; kB = 0.114f; break;
+        case 7: kR = 0.212f; kB = 0.087f; break;
+        case 9:
+        case 10: kR = 0.2627f; kB = 0.0593f; break;
+        default: throw std::runtime_error("tcolormask: unsupported matrix " + std::to_string(params.matrix) + ".");
+    }
+
+    constexpr int bits = sizeof(T) * 8;
+    constexpr float scale = (sizeof(T) == 1) ? 1.0f : 256.0f;
+    const float y_offset = (params.fullRange) ? 0.0f : 16.0f * scale;
+    const float y_range = (params.fullRange) ? peak : 219.0f * scale;
+    const float c_range = (params.fullRange) ? peak / 2.0f : 112.0f * scale;
+    const int c_offset = (peak + 1) / 2;
+
+    const size_t count = params.colors.size() + params.yuvColors.size();
+
+    // Graded values and indices can't be combined from per-plane LUTs.
+    // The Y/U/V LUT of metric=euclid has 2^24 entries for 8-bit, there's none for 16-bit.
+    const bool lut = !params.soft && !params.index && count > static_cast<size_t>(params.lutthr) && (!params.euclid || sizeof(T) == 1);
+    const bool lut3d = lut && params.euclid;
+
+    // One block for the color arrays and the LUTs, each 64-byte aligned.
+    size_t arena_size = 0;
+    auto reserve = [&](size_t bytes)
+    {
+        const size_t offset = arena_size;
+        arena_size += (bytes + 63) & ~static_cast<size_t>(63);
+        return offset;
+    };
+
+    size_t plane_offsets[6];
+    for (size_t& offset : plane_offsets)
+        offset = reserve(count * sizeof(T));
+    const size_t radius2_offset = reserve(count * sizeof(int64_t));
+    size_t scale_offsets[3];
+    for (size_t& offset : scale_offsets)
+        offset = reserve(count * sizeof(float));
+
+    const size_t lut_size = (lut3d) ? 1 << 21 : (lut) ? (peak + 1) * sizeof(T) : 0;
+    const size_t lut_offset = reserve((lut3d) ? lut_size : lut_size * 3);
+
+    // The 16-bit LUTs and the Y/U/V LUT are read at random over hundreds of 4 KiB pages.
+    arena_.allocate(arena_size, lut_size >= 64 * 1024);
+    uint8_t* arena = arena_.data();
+
+    T** planes[]{ &colors_.Y, &colors_.U, &colors_.V, &colors_.tolY, &colors_.tolU, &colors_.tolV };
+    for (int i = 0; i < 6; ++i)
+        *planes[i] = reinterpret_cast<T*>(arena + plane_offsets[i]);
+    colors_.radius2 = reinterpret_cast<int64_t*>(arena + radius2_offset);
+    float** scales[]{ &colors_.scaleY, &colors_.scaleU, &colors_.scaleV };
+    for (int i = 0; i < 3; ++i)
+        *scales[i] = reinterpret_cast<float*>(arena + scale_offsets[i]);
+
+    colors_.weightY = params.weightY;
+    colors_.weightU = params.weightU;
+    colors_.weightV = params.weightV;
+
+    // The mask is read by the next filter much later, don't let it evict the source of the following frames.
+    if (params.stream == -1)
+    {
+        static const size_t llc = lastLevelCacheSize();
+        const size_t plane = static_cast<size_t>(width_) * height_ * sizeof(T);
+        // Source and mask.
+        const size_t frame_bytes = plane * 2 + plane * 2 / (subsamplingX_ * subsamplingY_);
+        colors_.stream = llc && frame_bytes > llc;
+    }
+    else
+        colors_.stream = params.stream == 1;
+
+    auto addColor = [&](int y, int u, int v, const TColorMaskColor& color)
+    {
+        const int tol_y = (color.tolY == -1) ? tolerance : color.tolY;
+        // RGB planes are equally important, YUV chroma gets half the luma tolerance.
+        const int tol_c = (params.rgb) ? tol_y : tol_y / 2;
+        const int tol_u = (color.tolU == -1) ? tol_c : color.tolU;
+        const int tol_v = (color.tolV == -1) ? tol_c : color.tolV;
+
+        if (tol_y < 0 || tol_y > peak || tol_u < 0 || tol_u > peak || tol_v < 0 || tol_v > peak)
+            throw std::runtime_error("tcolormask: tolerance must be between 0.." + std::to_string(peak));
+
+        const size_t i = colors_.count++;
+
+        colors_.Y[i] = y;
+        colors_.U[i] = u;
+        colors_.V[i] = v;
+        colors_.tolY[i] = tol_y;
+        colors_.tolU[i] = tol_u;
+        colors_.tolV[i] = tol_v;
+        colors_.radius2[i] = static_cast<int64_t>(tol_y) * tol_y;
+        colors_.scaleY[i] = (tol_y) ? static_cast<float>(peak) / tol_y : 0.0f;
+        colors_.scaleU[i] = (tol_u) ? static_cast<float>(peak) / tol_u : 0.0f;
+        colors_.scaleV[i] = (tol_v) ? static_cast<float>(peak) / tol_v : 0.0f;
+    };
+
+    if (params.rgb)
+    {
+        if (subsamplingX_ != 1 || subsamplingY_ != 1)
+            throw std::runtime_error("tcolormask: RGB planes cannot be subsampled.");
+        if (!params.yuvColors.empty())
+            throw std::runtime_error("tcolormask: yuvcolors and space=\"yuv\" cannot be used with RGB clips.");
+
+        // Compared directly, the R/G/B planes take the place of Y/U/V.
+        for (const auto& color : params.colors)
+            addColor(static_cast<int>((color.value >> (bits * 2)) & peak), static_cast<int>((color.value >> bits) & peak), static_cast<int>(color.value & peak), color);
+    }
+    else
+    {
+        for (const auto& color : params.colors)
+        {
+            const float r = static_cast<float>((color.value >> (bits * 2)) & peak) / peak;
+            const float g = static_cast<float>((color.value >> bits) & peak) / peak;
+            const float b = static_cast<float>(color.value & peak) / peak;
+
+            const float y = kR * r + (1 - kR - kB) * g + kB * b;
+
+            addColor(std::clamp(depfree_round(y_offset + y_range * y), 0, peak),
+                std::clamp(c_offset + depfree_round(c_range * (b - y) / (1 - kB)), 0, peak),
+                std::clamp(c_offset + depfree_round(c_range * (r - y) / (1 - kR)), 0, peak),
+                color);
+        }
+    }
+
+    for (const auto& color : params.yuvColors)
+        addColor(static_cast<int>((color.value >> (bits * 2)) & peak), static_cast<int>((color.value >> bits) & peak), static_cast<int>(color.value & peak), color);
+
+    ctx_.colors = &colors_;
+    ctx_.lutY = nullptr;
+    ctx_.lutU = nullptr;
+    ctx_.lutV = nullptr;
+    ctx_.lut3d = nullptr;
+
+    if (lut3d)
+    {
+        uint8_t* lut_3d = arena + lut_offset;
+        buildLut3d(lut_3d);
+        ctx_.lut3d = lut_3d;
+    }
+    else if (lut)
+    {
+        T* lut_y = reinterpret_cast<T*>(arena + lut_offset);
+        T* lut_u = reinterpret_cast<T*>(arena + lut_offset + lut_size);
+        T* lut_v = reinterpret_cast<T*>(arena + lut_offset + lut_size * 2);
+        buildLuts(lut_y, lut_u, lut_v);
+        ctx_.lutY = lut_y;
+        ctx_.lutU = lut_u;
+        ctx_.lutV = lut_v;
+    }
+
+    ctx_.subsamplingX = subsamplingX_;
+
+    const bool border = (roi_width_ % ctx_.step) != 0;
+
+    // The kernels are specialized on the number of colors.
+    if (subsamplingX_ == 1 && subsamplingY_ == 1)
+        setKernels<1, 1>(isa, border, lut, params);
+    else if (subsamplingX_ == 2 && subsamplingY_ == 2)
+    {
+        if (mt_ && (roi_height_ / 2) % 2 != 0)
+            throw std::runtime_error("tcolormask: chroma height must be mod2 for mt=true!");
+
+        setKernels<2, 2>(isa, border, lut, params);
+    }
+    else if (subsamplingX_ == 2 && subsamplingY_ == 1)
+        setKernels<2, 1>(isa, border, lut, params);
+    else
+        throw std::runtime_error("tcolormask: only YUV420, YUV422 and YUV444 are supported!");
+}
+
+template <typename T>
+void TColorMaskCore<T>::buildLuts(T* lutY, T* lutU, T* lutV) const noexcept
+{
+    constexpr int peak = std::numeric_limits<T>::max();
+    const int range_max = peak + 1;
+
+    for (int i = 0; i < range_max; ++i)
+    {
+        T val_y = 0;
+        T val_u = 0;
+        T val_v = 0;
+
+        for (size_t c = 0; c < colors_.size(); ++c)
+        {
+            val_y |= ((abs(i - colors_.Y[c]) < colors_.tolY[c]) ? peak : 0);
+            val_u |= ((abs(i - colors_.U[c]) < colors_.tolU[c]) ? peak : 0);
+            val_v |= ((abs(i - colors_.V[c]) < colors_.tolV[c]) ? peak : 0);
+        }
+
+        lutY[i] = val_y;
+        lutU[i] = val_u;
+        lutV[i] = val_v;
+    }
+}
+
+template <typename T>
+void TColorMaskCore<T>::buildLut3d(uint8_t* lut) const noexcept
+{
+    if constexpr (sizeof(T) == 1)
+    {
+        memset(lut, 0, 1 << 21);
+
+        // Largest difference that can still pass in a plane.
+        auto reach = [](int64_t radius2, int weight)
+        {
+            if (weight == 0)
+                return 255;
+
+            int d = 0;
+            while (d < 255 && weight * static_cast<int64_t>(d + 1) * (d + 1) < radius2)
+                ++d;
+
+            return d;
+        };
+
+        for (size_t c = 0; c < colors_.size(); ++c)
+        {
+            const int64_t radius2 = colors_.radius2[c];
+            const int reach_y = reach(radius2, colors_.weightY);
+            const int reach_u = reach(radius2, colors_.weightU);
+            const int reach_v = reach(radius2, colors_.weightV);
+
+            for (int y = std::max(colors_.Y[c] - reach_y, 0); y <= std::min(colors_.Y[c] + reach_y, 255); ++y)
+            {
+                for (int u = std::max(colors_.U[c] - reach_u, 0); u <= std::min(colors_.U[c] + reach_u, 255); ++u)
+                {
+                    for (int v = std::max(colors_.V[c] - reach_v, 0); v <= std::min(colors_.V[c] + reach_v, 255); ++v)
+                    {
+                        const int dy = y - colors_.Y[c];
+                        const int du = u - colors_.U[c];
+                        const int dv = v - colors_.V[c];
+
+                        if (static_cast<int64_t>(colors_.weightY) * dy * dy + colors_.weightU * du * du + colors_.weightV * dv * dv < radius2)
+                        {
+                            const int index = (y << 16) | (u << 8) | v;
+                            lut[index >> 3] |= 1 << (index & 7);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void TColorMaskCore<T>::process(T* __restrict dstY_ptr, const T* srcY_ptr, const T* srcU_ptr, const T* srcV_ptr, int dst_pitch_y, int src_pitch_y, int src_pitch_uv) const noexcept
+{
+    T* __restrict dst_roi = dstAt(dstY_ptr, dst_pitch_y, roi_left_, roi_top_);
+    srcY_ptr += roi_top_ * src_pitch_y + roi_left_;
+    srcU_ptr += (roi_top_ / subsamplingY_) * src_pitch_uv + roi_left_ / subsamplingX_;
+    srcV_ptr += (roi_top_ / subsamplingY_) * src_pitch_uv + roi_left_ / subsamplingX_;
+
+    if (mt_)
+    {
+        const int half = roi_height_ / 2;
+
+        //async seems to be threadpool'ed on windows, creating threads is less efficient
+        auto thread2 = std::async(std::launch::async, [=] {
+            run(dst_roi,
+                srcY_ptr,
+                srcV_ptr,
+                srcU_ptr,
+                dst_pitch_y,
+                src_pitch_y,
+                src_pitch_uv,
+                roi_width_,
+                half);
+            });
+        run(dst_roi + dst_pitch_y * half,
+            srcY_ptr + src_pitch_y * half,
+            srcV_ptr + src_pitch_uv * (half / subsamplingY_),
+            srcU_ptr + src_pitch_uv * (half / subsamplingY_),
+            dst_pitch_y,
+            src_pitch_y,
+            src_pitch_uv,
+            roi_width_,
+            roi_height_ - half);
+        thread2.wait();
+    }
+    else
+        run(dst_roi, srcY_ptr, srcV_ptr, srcU_ptr, dst_pitch_y, src_pitch_y, src_pitch_uv, roi_width_, roi_height_);
+
+    if (roi_fill_)
+        fillOutsideRoi(dstY_ptr, dst_pitch_y);
+}
+
+template <typename T>
+void TColorMaskCore<T>::fillOutsideRoi(T* dstY_ptr, int dst_pitch_y) const noexcept
+{
+    const int right = roi_left_ + roi_width_;
+    const int bottom = roi_top_ + roi_height_;
+
+    if (roi_left_ == 0 && roi_top_ == 0 && right == width_ && bottom == height_)
+        return;
+
+    for (int y = 0; y < height_; ++y)
+    {
+        T* row = dstY_ptr + y * dst_pitch_y;
+
+        if (y < roi_top_ || y >= bottom)
+            memset(row, 0, width_ * sizeof(T));
+        else
+        {
+            memset(row, 0, roi_left_ * sizeof(T));
+            memset(row + right, 0, (width_ - right) * sizeof(T));
+        }
+    }
+}
+
+template <typename T>
+template <typename F>
+void TColorMaskCore<T>::splitRows(F&& rows) const
+{
+    const int bottom = roi_top_ + roi_height_;
+
+    if (mt_)
+    {
+        const int half = roi_top_ + roi_height_ / 2;
+
+        auto thread2 = std::async(std::launch::async, [&] { rows(roi_top_, half, 0); });
+        rows(half, bottom, 1);
+        thread2.wait();
+    }
+    else
+        rows(roi_top_, bottom, 0);
+}
+
+template <typename T>
+void TColorMaskCore<T>::processGroups(const TColorMaskCore* const* cores, int count, T* const* dst_ptrs, const int* dst_pitches, const YUVPlanes<T>& src) noexcept
+{
+    if (count == 1)
+    {
+        cores[0]->process(dst_ptrs[0], src.Y, src.U, src.V, dst_pitches[0], src.pitchY, src.pitchUV);
+        return;
+    }
+
+    // The groups share the frame and the region of interest.
+    const TColorMaskCore& first = *cores[0];
+    const int left = first.roi_left_;
+
+    auto rows = [&](int top, int end, int)
+    {
+        for (int y = top; y < end; y += group_stripe)
+        {
+            const int h = std::min(group_stripe, end - y);
+            const int offset_uv = (y / first.subsamplingY_) * src.pitchUV + left / first.subsamplingX_;
+
+            for (int i = 0; i < count; ++i)
+            {
+                const TColorMaskCore& core = *cores[i];
+
+                core.run(core.dstAt(dst_ptrs[i], dst_pitches[i], left, y),
+                    src.Y + y * src.pitchY + left,
+                    src.V + offset_uv,
+                    src.U + offset_uv,
+                    dst_pitches[i], src.pitchY, src.pitchUV, first.roi_width_, h);
+            }
+        }
+    };
+
+    first.splitRows(rows);
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (cores[i]->roi_fill_)
+            cores[i]->fillOutsideRoi(dst_ptrs[i], dst_pitches[i]);
+    }
+}
+
+template <typename T>
+void TColorMaskCore<T>::processPacked(const TColorMaskCore* const* cores, int count, T* const* dst_ptrs, const int* dst_pitches, const PackedPlanes<T>& src)
+{
+    const TColorMaskCore& first = *cores[0];
+    const int left = first.roi_left_;
+    const int width = first.roi_width_;
+    const int width_uv = width / first.subsamplingX_;
+    const int stripe_uv = group_stripe / first.subsamplingY_;
+    const int pitch = scratchPitch(width);
+    const int pitch_uv = scratchPitch(width_uv);
+    const size_t scratch_size = scratchSize(width, first.subsamplingX_, first.subsamplingY_);
+
+    // Owned by the calling frame thread for both workers, frames processed concurrently never share it.
+    // It only grows, there is no allocation once a thread has processed its first frame.
+    static thread_local std::vector<T> scratch_buf;
+    const size_t scratch_total = scratch_size * ((first.mt_) ? 2 : 1);
+    if (scratch_buf.size() < scratch_total)
+        scratch_buf.resize(scratch_total);
+    T* scratch = scratch_buf.data();
+
+    auto rows = [&](int top, int end, int worker)
+    {
+        // Planar copy of a stripe, the luma of semi-planar sources is used in place.
+        T* buf_u = scratch + scratch_size * worker;
+        T* buf_v = buf_u + pitch_uv * stripe_uv;
+        T* buf_y = buf_v + pitch_uv * stripe_uv;
+
+        for (int y = top; y < end; y += group_stripe)
+        {
+            const int h = std::min(group_stripe, end - y);
+            const T* srcY_ptr;
+            int src_pitch_y;
+
+            if (src.UV)
+            {
+                for (int i = 0; i < h / first.subsamplingY_; ++i)
+                    first.ctx_.deinterleaveUV(buf_u + i * pitch_uv, buf_v + i * pitch_uv, src.UV + (y / first.subsamplingY_ + i) * src.pitchUV + left / first.subsamplingX_ * 2, width_uv);
+
+                srcY_ptr = src.Y + y * src.pitchY + left;
+                src_pitch_y = src.pitchY;
+            }
+            else
+            {
+                for (int i = 0; i < h; ++i)
+                    first.ctx_.deinterleaveYUY2(buf_y + i * pitch, buf_u + i * pitch_uv, buf_v + i * pitch_uv, src.Y + (y + i) * src.pitchY + left * 2, width_uv);
+
+                srcY_ptr = buf_y;
+                src_pitch_y = pitch;
+            }
+
+            for (int i = 0; i < count; ++i)
+            {
+                const TColorMaskCore& core = *cores[i];
+                core.run(core.dstAt(dst_ptrs[i], dst_pitches[i], left, y), srcY_ptr, buf_v, buf_u, dst_pitches[i], src_pitch_y, pitch_uv, width, h);
+            }
+        }
+    };
+
+    first.splitRows(rows);
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (cores[i]->roi_fill_)
+            cores[i]->fillOutsideRoi(dst_ptrs[i], dst_pitches[i]);
+    }
+}
+
+static constexpr int delta_tile = 64;
+
+static inline bool rectEqual(const void* a, const void* b, int pitch_a, int pitch_b, int row_size, int height) noexcept
+{
+    const uint8_t* pa = reinterpret_cast<const uint8_t*>(a);
+    const uint8_t* pb = reinterpret_cast<const uint8_t*>(b);
+
+    for (int y = 0; y < height; ++y)
+    {
+        if (memcmp(pa, pb, row_size))
+            return false;
+
+        pa += pitch_a;
+        pb += pitch_b;
+    }
+
+    return true;
+}
+
+template <typename T>
+bool TColorMaskCore<T>::tileChanged(const YUVPlanes<T>& src, const YUVPlanes<T>& prev_src, int left, int top, int width, int height) const noexcept
+{
+    if (!rectEqual(src.Y + top * src.pitchY + left, prev_src.Y + top * prev_src.pitchY + left, src.pitchY * sizeof(T), prev_src.pitchY * sizeof(T), width * sizeof(T), height))
+        return true;
+
+    const int offset = (top / subsamplingY_) * src.pitchUV + left / subsamplingX_;
+    const int prev_offset = (top / subsamplingY_) * prev_src.pitchUV + left / subsamplingX_;
+    const int row_size = (width / subsamplingX_) * sizeof(T);
+    const int height_uv = height / subsamplingY_;
+
+    return !rectEqual(src.U + offset, prev_src.U + prev_offset, src.pitchUV * sizeof(T), prev_src.pitchUV * sizeof(T), row_size, height_uv) ||
+        !rectEqual(src.V + offset, prev_src.V + prev_offset, src.pitchUV * sizeof(T), prev_src.pitchUV * sizeof(T), row_size, height_uv);
+}
+
+template <typename T>
+void TColorMaskCore<T>::processDeltaRows(T* __restrict dstY_ptr, int dst_pitch_y, const YUVPlanes<T>& src, const T* prev_dst, int prev_dst_pitch, const YUVPlanes<T>& prev_src, int top, int bottom) const noexcept
+{
+    const int right = roi_left_ + roi_width_;
+
+    for (int y = top; y < bottom; y += delta_tile)
+    {
+        const int h = std::min(delta_tile, bottom - y);
+
+        // Runs of neighbouring tiles with the same state are masked or copied at once.
+        int x = roi_left_;
+        bool changed = tileChanged(src, prev_src, x, y, std::min(delta_tile, right - x), h);
+
+        while (x < right)
+        {
+            int x_end = x + delta_tile;
+            bool next_changed = changed;
+
+            while (x_end < right)
+            {
+                next_changed = tileChanged(src, prev_src, x_end, y, std::min(delta_tile, right - x_end), h);
+                if (next_changed != changed)
+                    break;
+
+                x_end += delta_tile;
+            }
+
+            x_end = std::min(x_end, right);
+
+            if (changed)
+            {
+                run(dstAt(dstY_ptr, dst_pitch_y, x, y),
+                    src.Y + y * src.pitchY + x,
+                    src.V + (y / subsamplingY_) * src.pitchUV + x / subsamplingX_,
+                    src.U + (y / subsamplingY_) * src.pitchUV + x / subsamplingX_,
+                    dst_pitch_y, src.pitchY, src.pitchUV, x_end - x, h);
+            }
+            else
+            {
+                for (int i = 0; i < h; ++i)
+                    memcpy(dstAt(dstY_ptr, dst_pitch_y, x, y + i), dstAt(prev_dst, prev_dst_pitch, x, y + i), (x_end - x) * sizeof(T));
+            }
+
+            x = x_end;
+            changed = next_changed;
+        }
+    }
+}
+
+template <typename T>
+void TColorMaskCore<T>::processDelta(T* __restrict dstY_ptr, int dst_pitch_y, const YUVPlanes<T>& src, const T* prev_dst, int prev_dst_pitch, const YUVPlanes<T>& prev_src) const noexcept
+{
+    const int bottom = roi_top_ + roi_height_;
+
+    if (mt_)
+    {
+        const int half = std::min(roi_top_ + ((roi_height_ / delta_tile + 1) / 2) * delta_tile, bottom);
+
+        auto thread2 = std::async(std::launch::async, [=, &src, &prev_src] {
+            processDeltaRows(dstY_ptr, dst_pitch_y, src, prev_dst, prev_dst_pitch, prev_src, roi_top_, half);
+            });
+        processDeltaRows(dstY_ptr, dst_pitch_y, src, prev_dst, prev_dst_pitch, prev_src, half, bottom);
+        thread2.wait();
+    }
+    else
+        processDeltaRows(dstY_ptr, dst_pitch_y, src, prev_dst, prev_dst_pitch, prev_src, roi_top_, bottom);
+
+    if (roi_fill_)
+        fillOutsideRoi(dstY_ptr, dst_pitch_y);
+}
+
+template class TColorMaskCore<uint8_t>;
+template class TColorMaskCore<uint16_t>;
+
+static bool matrixSupported(int matrix) noexcept
+{
+    return matrix == 1 || (matrix >= 4 && matrix <= 7) || matrix == 9 || matrix == 10;
+}
+
+template <typename T>
+TColorMaskEngines<T>::TColorMaskEngines(const TColorMaskParams& params, bool forceMatrix)
+    : params_(params), force_matrix_(forceMatrix), groups_(1)
+{
+    for (const auto* colors : { &params_.colors, &params_.yuvColors })
+    {
+        for (const auto& color : *colors)
+        {
+            if (color.group < 0 || color.group > 2)
+                throw std::runtime_error("tcolormask: color group must be between 0..2.");
+
+            groups_ = std::max(groups_, color.group + 1);
+        }
+    }
+
+    get(-1, -1);
+}
+
+template <typename T>
+const TColorMaskCore<T>* const* TColorMaskEngines<T>::get(int matrix, int range)
+{
+    int m = params_.matrix;
+    bool full = params_.fullRange;
+
+    // Only RGB colors of YUV clips depend on the matrix and range.
+    if (!params_.colors.empty() && !params_.rgb)
+    {
+        if (!force_matrix_ && matrixSupported(matrix))
+            m = matrix;
+        if (range == 0 || range == 1)
+            full = range == 0;
+    }
+
+    // Same coefficients.
+    if (m == 5)
+        m = 6;
+    else if (m == 10)
+        m = 9;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = engines_.find(m * 2 + full);
+    if (it == engines_.end())
+    {
+        std::array<const TColorMaskCore<T>*, 3> cores{};
+
+        for (int group = 0; group < groups_; ++group)
+        {
+            TColorMaskParams params = params_;
+            params.matrix = m;
+            params.fullRange = full;
+
+            auto inGroup = [group](const TColorMaskColor& color) { return color.group == group; };
+            params.colors.clear();
+            params.yuvColors.clear();
+            std::copy_if(params_.colors.begin(), params_.colors.end(), std::back_inserter(params.colors), inGroup);
+            std::copy_if(params_.yuvColors.begin(), params_.yuvColors.end(), std::back_inserter(params.yuvColors), inGroup);
+
+            owned_.emplace_back(std::make_unique<const TColorMaskCore<T>>(params));
+            cores[group] = owned_.back().get();
+        }
+
+        it = engines_.emplace(m * 2 + full, cores).first;
+    }
+
+    return it->second.data();
+}
+
+template class TColorMaskEngines<uint8_t>;
+template class TColorMaskEngines<uint16_t>;
+
+static constexpr uint64_t prime64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t prime64_3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t prime64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t prime64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t avalanche(uint64_t h) noexcept
+{
+    h ^= h >> 33;
+    h *= prime64_2;
+    h ^= h >> 29;
+    h *= prime64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+/* XXH3 style accumulation of one 64-byte stripe: 32x32->64 multiplies only, pmuludq in the SIMD versions. */
+static inline void accumulateStripe(uint64_t* __restrict acc, const uint8_t* stripe, const uint64_t* secret, uint64_t salt) noexcept
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        uint64_t data;
+        memcpy(&data, stripe + i * 8, 8);
+        const uint64_t key = data ^ secret[i] ^ salt;
+        acc[i ^ 1] += data;
+        acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+    }
+}
+
+/* Makes the result depend on the row order. */
+static inline void scrambleAcc(uint64_t* __restrict acc, const uint64_t* secret) noexcept
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        acc[i] ^= acc[i] >> 47;
+        acc[i] ^= secret[i];
+        acc[i] *= 0x9E3779B1;
+    }
+}
+
+static void hashRowsC(uint64_t* acc, const uint8_t* row, int row_size, int height, int pitch, const uint64_t* secret, uint64_t salt) noexcept
+{
+    const int stripes = row_size / 64;
+    const int tail = row_size % 64;
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int i = 0; i < stripes; ++i)
+            accumulateStripe(acc, row + i * 64, secret, i * salt);
+
+        if (tail)
+        {
+            alignas(64) uint8_t last[64] = {};
+            memcpy(last, row + stripes * 64, tail);
+            accumulateStripe(acc, last, secret, stripes * salt);
+        }
+
+        scrambleAcc(acc, secret);
+
+        row += pitch;
+    }
+}
+
+uint64_t hashPlane(const void* ptr, int row_size, int height, int pitch, uint64_t seed) noexcept
+{
+    alignas(64) static constexpr uint64_t secret[8] = { prime64_1, prime64_2, prime64_3, prime64_4, prime64_5, prime64_1 ^ prime64_4, prime64_2 ^ prime64_5, prime64_3 ^ prime64_1 };
+    alignas(64) uint64_t acc[8] = { seed, prime64_1, prime64_2, prime64_3, prime64_4, prime64_5, ~seed, prime64_1 + prime64_2 };
+
+    // Every source frame is hashed with cache, hit or miss.
+    static const auto hash_rows = (cpuLevel() >= 2) ? hashRowsAvx2 : (cpuLevel() == 1) ? hashRowsSse2 : hashRowsC;
+    hash_rows(acc, reinterpret_cast<const uint8_t*>(ptr), row_size, height, pitch, secret, prime64_4);
+
+    uint64_t h = seed ^ (static_cast<uint64_t>(row_size) * prime64_1) ^ (static_cast<uint64_t>(height) * prime64_2);
+
+    for (int i = 0; i < 8; ++i)
+        h = avalanche(h ^ (acc[i] * prime64_3) ^ secret[i]);
+
+    return h;
+}
+
+// Position of str[pos] for error messages, counted from 1.
+[[noreturn]] static void throwParseError(std::string_view str, size_t pos, const std::string& what)
+{
+    size_t line = 1;
+    size_t line_start = 0;
+
+    for (size_t i = 0; i < pos; ++i)
+    {
+        if (str[i] == '\n')
+        {
+            ++line;
+            line_start = i + 1;
+        }
+    }
+
+    throw std::runtime_error("tcolormask: " + what + " at line " + std::to_string(line) + ", column " + std::to_string(pos - line_start + 1) + ".");
+}
+
+static inline int hexDigit(char c) noexcept
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+
+    return -1;
+}
+
+static inline bool isSeparator(char c) noexcept
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',';
+}
+
+// "[tol]" or "[tolY,tolU,tolV]" starting at str[pos], returns the position after ']'.
+static size_t parseTolerances(std::string_view str, size_t pos, int bits, TColorMaskColor& color)
+{
+    const size_t size = str.size();
+    const int peak = (1 << bits) - 1;
+    int tolerances[3];
+    int count = 0;
+    size_t i = pos + 1;
+
+    while (true)
+    {
+        while (i < size && isSeparator(str[i]))
+            ++i;
+
+        if (i == size)
+            throwParseError(str, pos, "unterminated tolerance");
+        if (str[i] == ']')
+            break;
+        if (count == 3 || str[i] < '0' || str[i] > '9')
+            throwParseError(str, i, std::string("unexpected character '") + str[i] + "'");
+
+        const size_t start = i;
+        int value = 0;
+
+        for (; i < size && str[i] >= '0' && str[i] <= '9'; ++i)
+        {
+            value = value * 10 + (str[i] - '0');
+            if (value > peak)
+                throwParseError(str, start, "tolerance is out of range");
+        }
+
+        tolerances[count++] = value;
+    }
+
+    // The chroma tolerances of a single value are derived by the engine (halved for YUV).
+    if (count == 1)
+        color.tolY = tolerances[0];
+    else if (count == 3)
+    {
+        color.tolY = tolerances[0];
+        color.tolU = tolerances[1];
+        color.tolV = tolerances[2];
+    }
+    else
+        throwParseError(str, pos, "expected 1 or 3 tolerances");
+
+    return i + 1;
+}
+
+void parseColors(std::string_view str, int bits, std::vector<TColorMaskColor>& colors)
+{
+    const size_t size = str.size();
+    size_t i = 0;
+    int group = 0;
+
+    while (i < size)
+    {
+        const char c = str[i];
+
+        if (isSeparator(c))
+        {
+            ++i;
+            continue;
+        }
+
+        if (c == '|')
+        {
+            if (++group > 2)
+                throwParseError(str, i, "more than 3 color groups");
+
+            ++i;
+            continue;
+        }
+
+        if (c == '/' && i + 1 < size && str[i + 1] == '/')
+        {
+            while (i < size && str[i] != '\n')
+                ++i;
+
+            continue;
+        }
+
+        if (c == '/' && i + 1 < size && str[i + 1] == '*')
+        {
+            const size_t end = str.find("*/", i + 2);
+            if (end == std::string_view::npos)
+                throwParseError(str, i, "unterminated block comment");
+
+            i = end + 2;
+            continue;
+        }
+
+        const size_t start = i;
+        uint64_t value = 0;
+        int digits = 0;
+
+        if (c == '$' || (c == '0' && i + 1 < size && (str[i + 1] == 'x' || str[i + 1] == 'X')))
+        {
+            i += (c == '$') ? 1 : 2;
+
+            for (int d; i < size && (d = hexDigit(str[i])) >= 0; ++i, ++digits)
+            {
+                if (digits == 16)
+                    throwParseError(str, start, "color is out of range");
+
+                value = (value << 4) | d;
+            }
+        }
+        else
+        {
+            for (; i < size && str[i] >= '0' && str[i] <= '9'; ++i, ++digits)
+            {
+                const uint64_t d = str[i] - '0';
+                if (value > (std::numeric_limits<uint64_t>::max() - d) / 10)
+                    throwParseError(str, start, "color is out of range");
+
+                value = value * 10 + d;
+            }
+        }
+
+        if (digits == 0 && i == size)
+            throwParseError(str, start, "incomplete color");
+        if (digits == 0)
+            throwParseError(str, i, std::string("unexpected character '") + str[i] + "'");
+        if (bits == 16 && digits < 12)
+            throwParseError(str, start, "wrong hex color for 16-bit");
+
+        TColorMaskColor color{ value };
+        color.group = group;
+
+        if (i < size && str[i] == '[')
+            i = parseTolerances(str, i, bits, color);
+
+        // A color must be followed by a separator, a comment, a group separator or the end of the string.
+        if (i < size && !isSeparator(str[i]) && str[i] != '/' && str[i] != '|')
+            throwParseError(str, i, std::string("unexpected character '") + str[i] + "'");
+
+        colors.emplace_back(color);
+    }
+}
+
+std::vector<TColorMaskColor> parseColors(std::string_view str, int bits)
+{
+    std::vector<TColorMaskColor> colors;
+    parseColors(str, bits, colors);
+
+    return colors;
+}
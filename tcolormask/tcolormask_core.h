@@ -0,0 +1,333 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Colors and their per-plane tolerances, one entry per color in each array.
+// The arrays are 64-byte aligned in the arena of the engine.
+template <typename T>
+struct YUVColors
+{
+    T* Y = nullptr;
+    T* U = nullptr;
+    T* V = nullptr;
+    T* tolY = nullptr;
+    T* tolU = nullptr;
+    T* tolV = nullptr;
+    // metric=euclid: tolY^2 and the plane weights.
+    int64_t* radius2 = nullptr;
+    // soft=true: peak / tolerance, 0 if the tolerance is 0.
+    float* scaleY = nullptr;
+    float* scaleU = nullptr;
+    float* scaleV = nullptr;
+    size_t count = 0;
+    int weightY = 1;
+    int weightU = 4;
+    int weightV = 4;
+    // Non-temporal mask stores and source prefetch, used when the destination rows are aligned.
+    bool stream = false;
+
+    size_t size() const noexcept { return count; }
+};
+
+// What a stripe of a TColorMaskCore needs, filled once by the constructor.
+// run is the fully specialized kernel (tail handling included) or LUT lookup of the configuration.
+template <typename T>
+struct TColorMaskContext
+{
+    void(*run)(T* __restrict pDstY, const T* pSrcY, const T* pSrcV, const T* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const TColorMaskContext& ctx) noexcept;
+    const YUVColors<T>* colors;
+    // Per-plane LUTs (peak + 1 entries), nullptr if not built.
+    const T* lutY;
+    const T* lutU;
+    const T* lutV;
+    // metric=euclid, 8-bit: one bit per Y/U/V triplet, nullptr if not built.
+    const uint8_t* lut3d;
+    int step; // pixels per kernel iteration
+    int subsamplingX;
+    // processPacked(): count U V pairs / Y0 U Y1 V groups of a source row to planar rows.
+    void(*deinterleaveUV)(T* __restrict dstU, T* __restrict dstV, const T* src, int count) noexcept;
+    void(*deinterleaveYUY2)(T* __restrict dstY, T* __restrict dstU, T* __restrict dstV, const T* src, int count) noexcept;
+};
+
+// Packed color (0xRRGGBB / 0xRRRRGGGGBBBB, or Y/U/V in the same layout) with optional per-plane tolerances.
+struct TColorMaskColor
+{
+    uint64_t value;
+    int tolY = -1; // -1: TColorMaskParams::tolerance
+    int tolU = -1; // -1: tolY (or TColorMaskParams::tolerance) / 2, not halved for RGB
+    int tolV = -1;
+    int group = 0; // 0..2, the output plane with several groups
+};
+
+// Non-temporal stores need every destination row aligned. pitch is in bytes.
+inline bool alignedRows(const void* ptr, size_t pitch, size_t alignment) noexcept
+{
+    return ((reinterpret_cast<uintptr_t>(ptr) | pitch) & (alignment - 1)) == 0;
+}
+
+// Read-only view of a source frame. Pitches are in pixels.
+template <typename T>
+struct YUVPlanes
+{
+    const T* Y;
+    const T* U;
+    const T* V;
+    int pitchY;
+    int pitchUV;
+};
+
+// Read-only view of a source frame with interleaved samples. Pitches are in samples.
+// UV == nullptr: packed 4:2:2 (Y0 U Y1 V, YUY2 style) in Y. Otherwise semi-planar (NV12/P010 style): luma in Y, U V pairs in UV.
+template <typename T>
+struct PackedPlanes
+{
+    const T* Y;
+    const T* UV;
+    int pitchY;
+    int pitchUV;
+};
+
+// Everything needed to build a mask engine for one clip.
+// The engine works on raw plane pointers and doesn't depend on AviSynth.
+struct TColorMaskParams
+{
+    int width = 0;
+    int height = 0;
+    int subsamplingX = 1; // 1 or 2
+    int subsamplingY = 1; // 1 or 2
+    std::vector<TColorMaskColor> colors;
+    std::vector<TColorMaskColor> yuvColors; // packed 0xYYUUVV / 0xYYYYUUUUVVVV, used as is
+    int tolerance = -1; // default luma tolerance, -1: 10 (8-bit) / 2570 (16-bit)
+    // Planar RGB: the colors are compared in RGB, the R, G, B planes are passed in place of Y, U, V.
+    bool rgb = false;
+    int matrix = 1; // _Matrix: 1 (BT.709), 4 (FCC), 5/6 (BT.601), 7 (SMPTE 240M), 9/10 (BT.2020)
+    bool fullRange = false;
+    int lutthr = 9;
+    // Euclidean metric: a pixel matches when weightY * dY^2 + weightU * dU^2 + weightV * dV^2 < tolY^2.
+    bool euclid = false;
+    int weightY = 1; // 0..128
+    int weightU = 4;
+    int weightV = 4;
+    // Graded mask: peak * (1 - distance / tolerance) of the closest color instead of 0/peak.
+    // The distance is the largest per-plane difference relative to its tolerance, or the Euclidean distance with euclid.
+    bool soft = false;
+    // Outputs 1 + the index of the first color matching in every plane instead of the mask, 0 if none.
+    // Colors are counted in the order of colors, then yuvColors.
+    bool index = false;
+    bool mt = false;
+    int opt = -1;
+    // Non-temporal mask stores: -1 when the frame doesn't fit in the last level cache, 0 never, 1 always.
+    int stream = -1;
+    // Region of interest, crop style: non-positive roiWidth/roiHeight are relative to the right/bottom edge.
+    int roiLeft = 0;
+    int roiTop = 0;
+    int roiWidth = 0;
+    int roiHeight = 0;
+    bool roiFill = true; // false: the destination is the region of interest only, roiWidth x roiHeight
+};
+
+// 64-byte aligned memory of an engine, allocated once.
+class AlignedArena
+{
+public:
+    // hugePages: back the block with transparent huge pages where the OS supports them.
+    void allocate(size_t size, bool hugePages);
+    uint8_t* data() const noexcept { return data_.get(); }
+
+private:
+    struct Free
+    {
+        void operator()(uint8_t* ptr) const noexcept;
+    };
+
+    std::unique_ptr<uint8_t, Free> data_;
+};
+
+// Masking engine for 8-bit (uint8_t) and 16-bit (uint16_t) planar YUV and RGB.
+// Construction validates the parameters and throws std::runtime_error on failure.
+template <typename T>
+class TColorMaskCore
+{
+public:
+    explicit TColorMaskCore(const TColorMaskParams& params);
+    // The context points into the engine.
+    TColorMaskCore(const TColorMaskCore&) = delete;
+    TColorMaskCore& operator=(const TColorMaskCore&) = delete;
+
+    // Pitches are in pixels. The destination plane has the same dimensions as the source luma.
+    // Only the region of interest is masked, the rest is zeroed. Without roiFill the destination is the region of interest only.
+    void process(T* __restrict dstY_ptr, const T* srcY_ptr, const T* srcU_ptr, const T* srcV_ptr, int dst_pitch_y, int src_pitch_y, int src_pitch_uv) const noexcept;
+
+    // Masks only the 64x64 tiles whose source differs from prev_src, the rest is copied from prev_dst.
+    // prev_dst must be the mask of prev_src produced by this engine.
+    void processDelta(T* __restrict dstY_ptr, int dst_pitch_y, const YUVPlanes<T>& src, const T* prev_dst, int prev_dst_pitch, const YUVPlanes<T>& prev_src) const noexcept;
+
+    // Masks the color groups of the same clip into their own planes (dst_ptrs[i] for cores[i]).
+    // The rows are processed in stripes by every group, so the source is read from memory once.
+    static void processGroups(const TColorMaskCore* const* cores, int count, T* const* dst_ptrs, const int* dst_pitches, const YUVPlanes<T>& src) noexcept;
+    // processGroups() for interleaved sources. The chroma (and the luma of packed sources) is deinterleaved
+    // into a planar scratch buffer a stripe at a time, then masked by the planar kernels.
+    // The scratch isn't in the arena: any number of frames can be masked by an engine at the same time, so it's
+    // per calling thread instead. It's allocated on the first frame of a thread, grows to the widest clip masked
+    // by that thread and lives as long as the thread.
+    static void processPacked(const TColorMaskCore* const* cores, int count, T* const* dst_ptrs, const int* dst_pitches, const PackedPlanes<T>& src);
+
+    int width() const noexcept { return width_; }
+    int height() const noexcept { return height_; }
+    // Region of interest with the relative width/height resolved.
+    int roiLeft() const noexcept { return roi_left_; }
+    int roiTop() const noexcept { return roi_top_; }
+    int roiWidth() const noexcept { return roi_width_; }
+    int roiHeight() const noexcept { return roi_height_; }
+
+private:
+    template <int subsamplingX, int subsamplingY>
+    void setKernels(int isa, bool border, bool lut, const TColorMaskParams& params) noexcept;
+    template <int subsamplingX, int subsamplingY, bool euclid>
+    void setSoftKernels(int isa, bool border) noexcept;
+    template <int subsamplingX, int subsamplingY, bool euclid>
+    void setIndexKernels(int isa, bool border) noexcept;
+    void buildLuts(T* lutY, T* lutU, T* lutV) const noexcept;
+    void buildLut3d(uint8_t* lut) const noexcept;
+
+    // Calls rows(top, bottom, worker) for the rows of the region of interest, split in two threads (workers 0 and 1) with mt.
+    template <typename F>
+    void splitRows(F&& rows) const;
+    void fillOutsideRoi(T* dstY_ptr, int dst_pitch_y) const noexcept;
+    // Destination of the source pixel (x, y), the destination starts at the region of interest without roiFill.
+    template <typename P>
+    P* dstAt(P* dst, int pitch, int x, int y) const noexcept
+    {
+        return (roi_fill_) ? dst + y * pitch + x : dst + (y - roi_top_) * pitch + (x - roi_left_);
+    }
+    bool tileChanged(const YUVPlanes<T>& src, const YUVPlanes<T>& prev_src, int left, int top, int width, int height) const noexcept;
+    void processDeltaRows(T* __restrict dstY_ptr, int dst_pitch_y, const YUVPlanes<T>& src, const T* prev_dst, int prev_dst_pitch, const YUVPlanes<T>& prev_src, int top, int bottom) const noexcept;
+
+    // Masks width x height pixels from the given pointers.
+    void run(T* __restrict dstY_ptr, const T* srcY_ptr, const T* srcV_ptr, const T* srcU_ptr, int dst_pitch_y, int src_pitch_y, int src_pitch_uv, int width, int height) const noexcept
+    {
+        ctx_.run(dstY_ptr, srcY_ptr, srcV_ptr, srcU_ptr, dst_pitch_y, src_pitch_y, src_pitch_uv, width, height, ctx_);
+    }
+
+    TColorMaskContext<T> ctx_;
+    YUVColors<T> colors_;
+    int width_;
+    int height_;
+    int roi_left_;
+    int roi_top_;
+    int roi_width_;
+    int roi_height_;
+    int subsamplingY_;
+    int subsamplingX_;
+    bool mt_;
+    bool roi_fill_;
+
+    // Colors and LUTs.
+    AlignedArena arena_;
+};
+
+// Engines for the matrix/range combinations found in the frame properties, each built once on first use.
+template <typename T>
+class TColorMaskEngines
+{
+public:
+    // params.matrix/fullRange are used for frames without (or with unsupported) properties.
+    // forceMatrix: ignore _Matrix.
+    // Builds the default engine, throws std::runtime_error on invalid parameters.
+    TColorMaskEngines(const TColorMaskParams& params, bool forceMatrix);
+
+    // matrix/range: _Matrix/_ColorRange values, -1 if not present.
+    // Returns the engines of the color groups, groups() of them.
+    const TColorMaskCore<T>* const* get(int matrix, int range);
+
+    int groups() const noexcept { return groups_; }
+
+private:
+    TColorMaskParams params_;
+    bool force_matrix_;
+    int groups_;
+
+    std::map<int, std::array<const TColorMaskCore<T>*, 3>> engines_;
+    std::vector<std::unique_ptr<const TColorMaskCore<T>>> owned_;
+    std::mutex mutex_;
+};
+
+// 64-bit xxHash style hash of a plane, used to detect repeated source frames.
+// row_size and pitch are in bytes. Chain planes by passing the previous hash as seed.
+uint64_t hashPlane(const void* ptr, int row_size, int height, int pitch, uint64_t seed) noexcept;
+
+// Parses the colors string in a single pass: "$RRGGBB" / "0xRRGGBB" hex or decimal colors separated by
+// whitespace or commas, // line and /* */ block comments.
+// A color can be followed by its tolerances: "[tol]" (chroma tol/2) or "[tolY,tolU,tolV]".
+// "|" starts the next color group, at most 3 groups.
+// Throws std::runtime_error with the line and column of the error on malformed input.
+std::vector<TColorMaskColor> parseColors(std::string_view str, int bits);
+// Appends the colors to an existing vector.
+void parseColors(std::string_view str, int bits, std::vector<TColorMaskColor>& colors);
+
+// Binary palette: "TCMPAL01", uint32 count, uint32 bits (8/16), count packed uint64 colors. All little-endian.
+constexpr char palette_magic[] = "TCMPAL01";
+constexpr size_t palette_magic_size = sizeof(palette_magic) - 1;
+
+// Loads a binary palette or a text file in the colors string syntax through a memory mapping.
+// The result is cached per path and bit depth and shared until the file's size or mtime changes.
+std::shared_ptr<const std::vector<TColorMaskColor>> loadPalette(const std::string& path, int bits);
+
+// colorCount: 1..max_unrolled_colors for the kernels specialized on the number of colors, 0 for any number.
+constexpr int max_unrolled_colors = 8;
+
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processSse2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processAvx2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processAvx512(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processEuclidSse2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processEuclidAvx2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processEuclidAvx512(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processSoftSse2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processSoftAvx2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processSoftAvx512(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processIndexSse2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processIndexAvx2(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processIndexAvx512(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept;
+
+// Per-plane LUTs of 8-bit with AVX-512 VBMI byte permutes.
+template <int subsamplingX, int subsamplingY>
+void processLutVbmi(uint8_t* __restrict pDstY, const uint8_t* pSrcY, const uint8_t* pSrcV, const uint8_t* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const TColorMaskContext<uint8_t>& ctx) noexcept;
+
+// processPacked() deinterleave. YUY2 is 8-bit only, 16-bit packed 4:2:2 uses the C version.
+template <typename T>
+void deinterleaveUVSse2(T* __restrict dstU, T* __restrict dstV, const T* src, int count) noexcept;
+template <typename T>
+void deinterleaveUVAvx2(T* __restrict dstU, T* __restrict dstV, const T* src, int count) noexcept;
+template <typename T>
+void deinterleaveUVAvx512(T* __restrict dstU, T* __restrict dstV, const T* src, int count) noexcept;
+void deinterleaveUVVbmi(uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept;
+void deinterleaveYUY2Sse2(uint8_t* __restrict dstY, uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept;
+void deinterleaveYUY2Avx2(uint8_t* __restrict dstY, uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept;
+void deinterleaveYUY2Avx512(uint8_t* __restrict dstY, uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept;
+void deinterleaveYUY2Vbmi(uint8_t* __restrict dstY, uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept;
+
+// hashPlane() rows, every version gives the same result.
+void hashRowsSse2(uint64_t* acc, const uint8_t* row, int row_size, int height, int pitch, const uint64_t* secret, uint64_t salt) noexcept;
+void hashRowsAvx2(uint64_t* acc, const uint8_t* row, int row_size, int height, int pitch, const uint64_t* secret, uint64_t salt) noexcept;
@@ -0,0 +1,195 @@
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "tcolormask_core.h"
+
+// Read-only mapping of a whole file.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path)
+    {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("tcolormask: cannot open colorfile " + path + ".");
+
+        LARGE_INTEGER size;
+        GetFileSizeEx(file_, &size);
+        size_ = static_cast<size_t>(size.QuadPart);
+
+        if (size_)
+        {
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            data_ = (mapping_) ? static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        }
+#else
+        fd_ = open(path.c_str(), O_RDONLY);
+        if (fd_ == -1)
+            throw std::runtime_error("tcolormask: cannot open colorfile " + path + ".");
+
+        struct stat st;
+        fstat(fd_, &st);
+        size_ = static_cast<size_t>(st.st_size);
+
+        if (size_)
+        {
+            void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            data_ = (data != MAP_FAILED) ? static_cast<const char*>(data) : nullptr;
+        }
+#endif
+
+        if (size_ && !data_)
+        {
+            close();
+            throw std::runtime_error("tcolormask: cannot map colorfile " + path + ".");
+        }
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view data() const noexcept { return { data_, size_ }; }
+
+private:
+    void close() noexcept
+    {
+#ifdef _WIN32
+        if (data_)
+            UnmapViewOfFile(data_);
+        if (mapping_)
+            CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE)
+            CloseHandle(file_);
+#else
+        if (data_)
+            munmap(const_cast<char*>(data_), size_);
+        if (fd_ != -1)
+            ::close(fd_);
+#endif
+    }
+
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+static inline uint32_t readLE32(const char* p) noexcept
+{
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(p);
+    return b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+static inline uint64_t readLE64(const char* p) noexcept
+{
+    return readLE32(p) | (static_cast<uint64_t>(readLE32(p + 4)) << 32);
+}
+
+// Converts a packed color between 8-bit and 16-bit components.
+static inline uint64_t convertColor(uint64_t color, int from_bits, int to_bits) noexcept
+{
+    if (from_bits == to_bits)
+        return color;
+
+    uint64_t result = 0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const uint64_t c = (color >> (i * from_bits)) & ((1ULL << from_bits) - 1);
+        result |= ((to_bits > from_bits) ? c * 257 : (c * 255 + 32895) / 65535) << (i * to_bits);
+    }
+
+    return result;
+}
+
+static std::vector<TColorMaskColor> parseBinaryPalette(std::string_view data, int bits, const std::string& path)
+{
+    constexpr size_t header_size = palette_magic_size + 8;
+
+    if (data.size() < header_size)
+        throw std::runtime_error("tcolormask: colorfile " + path + " is truncated.");
+
+    const uint32_t count = readLE32(data.data() + palette_magic_size);
+    const uint32_t file_bits = readLE32(data.data() + palette_magic_size + 4);
+
+    if (file_bits != 8 && file_bits != 16)
+        throw std::runtime_error("tcolormask: colorfile " + path + " has unsupported bit depth.");
+    if ((data.size() - header_size) / 8 < count)
+        throw std::runtime_error("tcolormask: colorfile " + path + " is truncated.");
+
+    std::vector<TColorMaskColor> colors(count);
+    const char* p = data.data() + header_size;
+
+    for (uint32_t i = 0; i < count; ++i)
+        colors[i].value = convertColor(readLE64(p + i * 8), file_bits, bits);
+
+    return colors;
+}
+
+std::shared_ptr<const std::vector<TColorMaskColor>> loadPalette(const std::string& path, int bits)
+{
+    struct Entry
+    {
+        std::filesystem::file_time_type mtime;
+        uintmax_t size;
+        std::shared_ptr<const std::vector<TColorMaskColor>> colors;
+    };
+
+    static std::mutex mutex;
+    static std::map<std::pair<std::string, int>, Entry> cache;
+
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec)
+        throw std::runtime_error("tcolormask: cannot open colorfile " + path + ".");
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto key = std::make_pair(path, bits);
+    const auto it = cache.find(key);
+    if (it != cache.end() && it->second.mtime == mtime && it->second.size == size)
+        return it->second.colors;
+
+    const MappedFile file(path);
+    const std::string_view data = file.data();
+
+    std::shared_ptr<const std::vector<TColorMaskColor>> colors;
+
+    if (data.size() >= palette_magic_size && !memcmp(data.data(), palette_magic, palette_magic_size))
+        colors = std::make_shared<const std::vector<TColorMaskColor>>(parseBinaryPalette(data, bits, path));
+    else
+    {
+        try { colors = std::make_shared<const std::vector<TColorMaskColor>>(parseColors(data, bits)); }
+        catch (const std::runtime_error& e) { throw std::runtime_error(std::string(e.what()) + " (colorfile " + path + ")"); }
+    }
+
+    cache[key] = { mtime, size, colors };
+
+    return colors;
+}
@@ -1,13 +1,37 @@
-#include "tcolormask.h"
+#include <cstring>
+
+#include "tcolormask_core.h"
 #include "VCL2/vectorclass.h"
 
-template <typename T, int subsamplingX, int subsamplingY>
-void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<T>>& colors, int tolerance, int halftolerance) noexcept
+// Non-temporal store of the mask, the rows must be 16-byte aligned.
+template <typename V, typename T>
+static inline void storeMask(const V& result, T* dst, bool stream) noexcept
+{
+    if (stream)
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), result);
+    else
+        result.store(dst);
+}
+
+// Source of the next row, requested while the current one is masked.
+template <typename T>
+static inline void prefetchRow(const T* srcY, const T* srcU, const T* srcV) noexcept
+{
+    _mm_prefetch(reinterpret_cast<const char*>(srcY), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(srcU), _MM_HINT_T0);
+    _mm_prefetch(reinterpret_cast<const char*>(srcV), _MM_HINT_T0);
+}
+
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
 {
     const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
     const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
     const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
     T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+    const bool stream = colors.stream && alignedRows(pDstY_, dstPitchY * sizeof(T), 16);
+    // Known at compile time for a few colors, so the color loop is unrolled with the colors in registers.
+    const size_t count = (colorCount) ? colorCount : colors.size();
 
     for (int y = 0; y < height; ++y)
     {
@@ -15,6 +39,9 @@ void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_
         {
             for (int x = 0; x < width; x += 16)
             {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
                 Vec16uc result_y = zero_si128();
                 Vec16uc result_u = zero_si128();
                 Vec16uc result_v = zero_si128();
@@ -35,11 +62,11 @@ void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_
                     srcV_v = Vec16uc().load(pSrcV + x);
                 }
 
-                for (auto& color : colors)
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const auto colorVector_y = Vec16uc(color.Y);
-                    const auto colorVector_u = Vec16uc(color.U);
-                    const auto colorVector_v = Vec16uc(color.V);
+                    const auto colorVector_y = Vec16uc(colors.Y[i]);
+                    const auto colorVector_u = Vec16uc(colors.U[i]);
+                    const auto colorVector_v = Vec16uc(colors.V[i]);
                     /* absolute difference */
                     const auto maximum_y = max(srcY_v, colorVector_y);
                     const auto maximum_u = max(srcU_v, colorVector_u);
@@ -53,9 +80,9 @@ void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_
                     const auto diff_u = maximum_u - minimum_u;
                     const auto diff_v = maximum_v - minimum_v;
                     /* comparing to tolerance */
-                    const auto diff_tolerance_min_y = max(diff_y, Vec16uc(tolerance));
-                    const auto diff_tolerance_min_u = max(diff_u, Vec16uc(halftolerance));
-                    const auto diff_tolerance_min_v = max(diff_v, Vec16uc(halftolerance));
+                    const auto diff_tolerance_min_y = max(diff_y, Vec16uc(colors.tolY[i]));
+                    const auto diff_tolerance_min_u = max(diff_u, Vec16uc(colors.tolU[i]));
+                    const auto diff_tolerance_min_v = max(diff_v, Vec16uc(colors.tolV[i]));
 
                     const auto passed_y = select(diff_y >= diff_tolerance_min_y, zero_si128(), Vec16uc(255));
                     const auto passed_u = select(diff_u >= diff_tolerance_min_u, zero_si128(), Vec16uc(255));
@@ -68,13 +95,16 @@ void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_
 
                 result_y = result_y & result_u;
                 result_y = result_y & result_v;
-                result_y.store(pDstY + x);
+                storeMask(result_y, pDstY + x, stream);
             }
         }
         else
         {
             for (int x = 0; x < width; x += 8)
             {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
                 Vec8us result_y = zero_si128();
                 Vec8us result_u = zero_si128();
                 Vec8us result_v = zero_si128();
@@ -95,11 +125,11 @@ void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_
                     srcV_v = Vec8us().load(pSrcV + x);
                 }
 
-                for (auto& color : colors)
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const auto colorVector_y = Vec8us(color.Y);
-                    const auto colorVector_u = Vec8us(color.U);
-                    const auto colorVector_v = Vec8us(color.V);
+                    const auto colorVector_y = Vec8us(colors.Y[i]);
+                    const auto colorVector_u = Vec8us(colors.U[i]);
+                    const auto colorVector_v = Vec8us(colors.V[i]);
                     /* absolute difference */
                     const auto maximum_y = max(srcY_v, colorVector_y);
                     const auto maximum_u = max(srcU_v, colorVector_u);
@@ -113,9 +143,9 @@ void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_
                     const auto diff_u = maximum_u - minimum_u;
                     const auto diff_v = maximum_v - minimum_v;
                     /* comparing to tolerance */
-                    const auto diff_tolerance_min_y = max(diff_y, Vec8us(tolerance));
-                    const auto diff_tolerance_min_u = max(diff_u, Vec8us(halftolerance));
-                    const auto diff_tolerance_min_v = max(diff_v, Vec8us(halftolerance));
+                    const auto diff_tolerance_min_y = max(diff_y, Vec8us(colors.tolY[i]));
+                    const auto diff_tolerance_min_u = max(diff_u, Vec8us(colors.tolU[i]));
+                    const auto diff_tolerance_min_v = max(diff_v, Vec8us(colors.tolV[i]));
 
                     const auto passed_y = select(diff_y >= diff_tolerance_min_y, zero_si128(), Vec8us(65535));
                     const auto passed_u = select(diff_u >= diff_tolerance_min_u, zero_si128(), Vec8us(65535));
@@ -128,7 +158,7 @@ void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_
 
                 result_y = result_y & result_u;
                 result_y = result_y & result_v;
-                result_y.store(pDstY + x);
+                storeMask(result_y, pDstY + x, stream);
             }
         }
 
@@ -142,18 +172,713 @@ void processSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_
 
         pDstY += dstPitchY;
     }
+
+    if (stream)
+        _mm_sfence();
+}
+
+// 0xFF where wY * dY^2 + wU * dU^2 + wV * dV^2 < radius2. The unpacks and packs are lane local, so the pixel order is kept.
+static inline Vec16uc euclidPass(const Vec16uc& dy, const Vec16uc& du, const Vec16uc& dv, const Vec8s& wy, const Vec8s& wu, const Vec8s& wv, const Vec4i& radius2) noexcept
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    auto half = [&](__m128i y16, __m128i u16, __m128i v16)
+    {
+        const __m128i wy16 = _mm_mullo_epi16(y16, wy);
+        const __m128i wu16 = _mm_mullo_epi16(u16, wu);
+        const __m128i wv16 = _mm_mullo_epi16(v16, wv);
+
+        const __m128i dist_lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y16, u16), _mm_unpacklo_epi16(wy16, wu16)),
+            _mm_madd_epi16(_mm_unpacklo_epi16(v16, zero), _mm_unpacklo_epi16(wv16, zero)));
+        const __m128i dist_hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y16, u16), _mm_unpackhi_epi16(wy16, wu16)),
+            _mm_madd_epi16(_mm_unpackhi_epi16(v16, zero), _mm_unpackhi_epi16(wv16, zero)));
+
+        return _mm_packs_epi32(_mm_cmpgt_epi32(radius2, dist_lo), _mm_cmpgt_epi32(radius2, dist_hi));
+    };
+
+    return _mm_packs_epi16(half(_mm_unpacklo_epi8(dy, zero), _mm_unpacklo_epi8(du, zero), _mm_unpacklo_epi8(dv, zero)),
+        half(_mm_unpackhi_epi8(dy, zero), _mm_unpackhi_epi8(du, zero), _mm_unpackhi_epi8(dv, zero)));
+}
+
+// 16-bit: the squares need 64 bits, even and odd 32-bit lanes are multiplied separately.
+static inline Vec8us euclidPass(const Vec8us& dy, const Vec8us& du, const Vec8us& dv, const Vec2uq& wy, const Vec2uq& wu, const Vec2uq& wv, const Vec2q& radius2) noexcept
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low_dwords = _mm_set_epi32(0, -1, 0, -1);
+
+    auto square = [](__m128i d, __m128i w)
+    {
+        return _mm_mul_epu32(_mm_mul_epu32(d, d), w);
+    };
+
+    auto pass = [&](__m128i y32, __m128i u32, __m128i v32)
+    {
+        const __m128i dist_even = _mm_add_epi64(_mm_add_epi64(square(y32, wy), square(u32, wu)), square(v32, wv));
+        const __m128i dist_odd = _mm_add_epi64(_mm_add_epi64(square(_mm_srli_epi64(y32, 32), wy), square(_mm_srli_epi64(u32, 32), wu)), square(_mm_srli_epi64(v32, 32), wv));
+        // dist - radius2 < 0, sign of the high dword copied to the whole qword.
+        const __m128i pass_even = _mm_shuffle_epi32(_mm_srai_epi32(_mm_sub_epi64(dist_even, radius2), 31), _MM_SHUFFLE(3, 3, 1, 1));
+        const __m128i pass_odd = _mm_shuffle_epi32(_mm_srai_epi32(_mm_sub_epi64(dist_odd, radius2), 31), _MM_SHUFFLE(3, 3, 1, 1));
+
+        return _mm_or_si128(_mm_and_si128(pass_even, low_dwords), _mm_andnot_si128(low_dwords, pass_odd));
+    };
+
+    return _mm_packs_epi32(pass(_mm_unpacklo_epi16(dy, zero), _mm_unpacklo_epi16(du, zero), _mm_unpacklo_epi16(dv, zero)),
+        pass(_mm_unpackhi_epi16(dy, zero), _mm_unpackhi_epi16(du, zero), _mm_unpackhi_epi16(dv, zero)));
 }
 
-template void processSse2<uint8_t, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint8_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-template void processSse2<uint8_t, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint8_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-template void processSse2<uint8_t, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint8_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-
-template void processSse2<uint16_t, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint16_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-template void processSse2<uint16_t, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint16_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
-template void processSse2<uint16_t, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const std::vector<YUVPixel<uint16_t>>& colors,
-    int tolerance, int halftolerance) noexcept;
+template <typename T, int subsamplingX, int subsamplingY, int colorCount>
+void processEuclidSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+    const bool stream = colors.stream && alignedRows(pDstY_, dstPitchY * sizeof(T), 16);
+    // Known at compile time for a few colors, so the color loop is unrolled with the colors in registers.
+    const size_t count = (colorCount) ? colorCount : colors.size();
+
+    for (int y = 0; y < height; ++y)
+    {
+        if constexpr (std::is_same_v<T, uint8_t>)
+        {
+            const Vec8s wy(colors.weightY);
+            const Vec8s wu(colors.weightU);
+            const Vec8s wv(colors.weightV);
+
+            for (int x = 0; x < width; x += 16)
+            {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+                Vec16uc result = zero_si128();
+
+                const auto srcY_v = Vec16uc().load(pSrcY + x);
+                Vec16uc srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = Vec16uc().loadl(pSrcU + x / subsamplingX);
+                    srcU_v = blend16<0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23>(srcU_v, srcU_v);
+                    srcV_v = Vec16uc().loadl(pSrcV + x / subsamplingX);
+                    srcV_v = blend16<0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23>(srcV_v, srcV_v);
+                }
+                else
+                {
+                    srcU_v = Vec16uc().load(pSrcU + x);
+                    srcV_v = Vec16uc().load(pSrcV + x);
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const auto colorVector_y = Vec16uc(colors.Y[i]);
+                    const auto colorVector_u = Vec16uc(colors.U[i]);
+                    const auto colorVector_v = Vec16uc(colors.V[i]);
+                    /* absolute difference */
+                    const auto diff_y = max(srcY_v, colorVector_y) - min(srcY_v, colorVector_y);
+                    const auto diff_u = max(srcU_v, colorVector_u) - min(srcU_v, colorVector_u);
+                    const auto diff_v = max(srcV_v, colorVector_v) - min(srcV_v, colorVector_v);
+
+                    result = result | euclidPass(diff_y, diff_u, diff_v, wy, wu, wv, Vec4i(static_cast<int>(colors.radius2[i])));
+                }
+
+                storeMask(result, pDstY + x, stream);
+            }
+        }
+        else
+        {
+            const Vec2uq wy(colors.weightY);
+            const Vec2uq wu(colors.weightU);
+            const Vec2uq wv(colors.weightV);
+
+            for (int x = 0; x < width; x += 8)
+            {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+                Vec8us result = zero_si128();
+
+                const auto srcY_v = Vec8us().load(pSrcY + x);
+                Vec8us srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = Vec8us().loadl(pSrcU + x / subsamplingX);
+                    srcU_v = blend8<0, 8, 1, 9, 2, 10, 3, 11>(srcU_v, srcU_v);
+                    srcV_v = Vec8us().loadl(pSrcV + x / subsamplingX);
+                    srcV_v = blend8<0, 8, 1, 9, 2, 10, 3, 11>(srcV_v, srcV_v);
+                }
+                else
+                {
+                    srcU_v = Vec8us().load(pSrcU + x);
+                    srcV_v = Vec8us().load(pSrcV + x);
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const auto colorVector_y = Vec8us(colors.Y[i]);
+                    const auto colorVector_u = Vec8us(colors.U[i]);
+                    const auto colorVector_v = Vec8us(colors.V[i]);
+                    /* absolute difference */
+                    const auto diff_y = max(srcY_v, colorVector_y) - min(srcY_v, colorVector_y);
+                    const auto diff_u = max(srcU_v, colorVector_u) - min(srcU_v, colorVector_u);
+                    const auto diff_v = max(srcV_v, colorVector_v) - min(srcV_v, colorVector_v);
+
+                    result = result | euclidPass(diff_y, diff_u, diff_v, wy, wu, wv, Vec2q(colors.radius2[i]));
+                }
+
+                storeMask(result, pDstY + x, stream);
+            }
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+
+    if (stream)
+        _mm_sfence();
+}
+
+// soft=true: (tolerance - difference) * peak / tolerance of the worst plane (or of the Euclidean distance), the best color wins.
+template <bool euclid>
+static inline Vec4f softPass(const Vec4f& srcY, const Vec4f& srcU, const Vec4f& srcV, const Vec4f& colorY, const Vec4f& colorU, const Vec4f& colorV,
+    const Vec4f& tolY, const Vec4f& tolU, const Vec4f& tolV, const Vec4f& scaleY, const Vec4f& scaleU, const Vec4f& scaleV, const Vec4f& wy, const Vec4f& wu, const Vec4f& wv) noexcept
+{
+    const auto diff_y = abs(srcY - colorY);
+    const auto diff_u = abs(srcU - colorU);
+    const auto diff_v = abs(srcV - colorV);
+
+    if constexpr (euclid)
+        return (tolY - sqrt(diff_y * diff_y * wy + diff_u * diff_u * wu + diff_v * diff_v * wv)) * scaleY;
+    else
+        return min(min((tolY - diff_y) * scaleY, (tolU - diff_u) * scaleU), (tolV - diff_v) * scaleV);
+}
+
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processSoftSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+    const bool stream = colors.stream && alignedRows(pDstY_, dstPitchY * sizeof(T), 16);
+
+    // Pixels per integer vector and the float vectors they are widened to.
+    constexpr int step = 16 / sizeof(T);
+    constexpr int parts = step / 4;
+    const Vec4f peak(static_cast<float>(std::numeric_limits<T>::max()));
+    const Vec4f wy(static_cast<float>(colors.weightY));
+    const Vec4f wu(static_cast<float>(colors.weightU));
+    const Vec4f wv(static_cast<float>(colors.weightV));
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; x += step)
+        {
+            if (stream)
+                prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+            Vec4f srcY_f[parts], srcU_f[parts], srcV_f[parts];
+            Vec4f value[parts];
+
+            if constexpr (std::is_same_v<T, uint8_t>)
+            {
+                const auto srcY_v = Vec16uc().load(pSrcY + x);
+                Vec16uc srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = Vec16uc().loadl(pSrcU + x / subsamplingX);
+                    srcU_v = blend16<0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23>(srcU_v, srcU_v);
+                    srcV_v = Vec16uc().loadl(pSrcV + x / subsamplingX);
+                    srcV_v = blend16<0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23>(srcV_v, srcV_v);
+                }
+                else
+                {
+                    srcU_v = Vec16uc().load(pSrcU + x);
+                    srcV_v = Vec16uc().load(pSrcV + x);
+                }
+
+                auto widen = [](const Vec16uc& v, Vec4f* out)
+                {
+                    const Vec8us lo = extend_low(v);
+                    const Vec8us hi = extend_high(v);
+                    out[0] = to_float(Vec4i(extend_low(lo)));
+                    out[1] = to_float(Vec4i(extend_high(lo)));
+                    out[2] = to_float(Vec4i(extend_low(hi)));
+                    out[3] = to_float(Vec4i(extend_high(hi)));
+                };
+
+                widen(srcY_v, srcY_f);
+                widen(srcU_v, srcU_f);
+                widen(srcV_v, srcV_f);
+            }
+            else
+            {
+                const auto srcY_v = Vec8us().load(pSrcY + x);
+                Vec8us srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = Vec8us().loadl(pSrcU + x / subsamplingX);
+                    srcU_v = blend8<0, 8, 1, 9, 2, 10, 3, 11>(srcU_v, srcU_v);
+                    srcV_v = Vec8us().loadl(pSrcV + x / subsamplingX);
+                    srcV_v = blend8<0, 8, 1, 9, 2, 10, 3, 11>(srcV_v, srcV_v);
+                }
+                else
+                {
+                    srcU_v = Vec8us().load(pSrcU + x);
+                    srcV_v = Vec8us().load(pSrcV + x);
+                }
+
+                auto widen = [](const Vec8us& v, Vec4f* out)
+                {
+                    out[0] = to_float(Vec4i(extend_low(v)));
+                    out[1] = to_float(Vec4i(extend_high(v)));
+                };
+
+                widen(srcY_v, srcY_f);
+                widen(srcU_v, srcU_f);
+                widen(srcV_v, srcV_f);
+            }
+
+            for (int p = 0; p < parts; ++p)
+                value[p] = Vec4f(0.0f);
+
+            for (size_t i = 0; i < colors.size(); ++i)
+            {
+                const Vec4f colorY(colors.Y[i]), colorU(colors.U[i]), colorV(colors.V[i]);
+                const Vec4f tolY(colors.tolY[i]), tolU(colors.tolU[i]), tolV(colors.tolV[i]);
+                const Vec4f scaleY(colors.scaleY[i]), scaleU(colors.scaleU[i]), scaleV(colors.scaleV[i]);
+
+                for (int p = 0; p < parts; ++p)
+                    value[p] = max(value[p], softPass<euclid>(srcY_f[p], srcU_f[p], srcV_f[p], colorY, colorU, colorV, tolY, tolU, tolV, scaleY, scaleU, scaleV, wy, wu, wv));
+            }
+
+            // The values are in 0..peak, compress doesn't need to saturate.
+            if constexpr (std::is_same_v<T, uint8_t>)
+            {
+                storeMask(compress(compress(Vec4ui(roundi(min(value[0], peak))), Vec4ui(roundi(min(value[1], peak)))),
+                    compress(Vec4ui(roundi(min(value[2], peak))), Vec4ui(roundi(min(value[3], peak))))), pDstY + x, stream);
+            }
+            else
+                storeMask(compress(Vec4ui(roundi(min(value[0], peak))), Vec4ui(roundi(min(value[1], peak)))), pDstY + x, stream);
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+
+    if (stream)
+        _mm_sfence();
+}
+
+// mode=index: 1 + the index of the first color matching in every plane, 0 if none.
+template <typename T, int subsamplingX, int subsamplingY, bool euclid>
+void processIndexSse2(void* __restrict pDstY_, const void* pSrcY_, const void* pSrcV_, const void* pSrcU_, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<T>& colors) noexcept
+{
+    const T* pSrcY = reinterpret_cast<const T*>(pSrcY_);
+    const T* pSrcV = reinterpret_cast<const T*>(pSrcV_);
+    const T* pSrcU = reinterpret_cast<const T*>(pSrcU_);
+    T* __restrict pDstY = reinterpret_cast<T*>(pDstY_);
+    const bool stream = colors.stream && alignedRows(pDstY_, dstPitchY * sizeof(T), 16);
+
+    for (int y = 0; y < height; ++y)
+    {
+        if constexpr (std::is_same_v<T, uint8_t>)
+        {
+            const Vec8s wy(colors.weightY);
+            const Vec8s wu(colors.weightU);
+            const Vec8s wv(colors.weightV);
+
+            for (int x = 0; x < width; x += 16)
+            {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+                Vec16uc result = zero_si128();
+
+                const auto srcY_v = Vec16uc().load(pSrcY + x);
+                Vec16uc srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = Vec16uc().loadl(pSrcU + x / subsamplingX);
+                    srcU_v = blend16<0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23>(srcU_v, srcU_v);
+                    srcV_v = Vec16uc().loadl(pSrcV + x / subsamplingX);
+                    srcV_v = blend16<0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23>(srcV_v, srcV_v);
+                }
+                else
+                {
+                    srcU_v = Vec16uc().load(pSrcU + x);
+                    srcV_v = Vec16uc().load(pSrcV + x);
+                }
+
+                // Backwards, so the first matching color is written last.
+                for (size_t i = colors.size(); i-- > 0;)
+                {
+                    const auto colorVector_y = Vec16uc(colors.Y[i]);
+                    const auto colorVector_u = Vec16uc(colors.U[i]);
+                    const auto colorVector_v = Vec16uc(colors.V[i]);
+                    /* absolute difference */
+                    const auto diff_y = max(srcY_v, colorVector_y) - min(srcY_v, colorVector_y);
+                    const auto diff_u = max(srcU_v, colorVector_u) - min(srcU_v, colorVector_u);
+                    const auto diff_v = max(srcV_v, colorVector_v) - min(srcV_v, colorVector_v);
+
+                    if constexpr (euclid)
+                    {
+                        const auto pass = euclidPass(diff_y, diff_u, diff_v, wy, wu, wv, Vec4i(static_cast<int>(colors.radius2[i])));
+                        result = (pass & Vec16uc(static_cast<T>(i + 1))) | (result & ~pass);
+                    }
+                    else
+                        result = select((diff_y < Vec16uc(colors.tolY[i])) & (diff_u < Vec16uc(colors.tolU[i])) & (diff_v < Vec16uc(colors.tolV[i])), Vec16uc(static_cast<T>(i + 1)), result);
+                }
+
+                storeMask(result, pDstY + x, stream);
+            }
+        }
+        else
+        {
+            const Vec2uq wy(colors.weightY);
+            const Vec2uq wu(colors.weightU);
+            const Vec2uq wv(colors.weightV);
+
+            for (int x = 0; x < width; x += 8)
+            {
+                if (stream)
+                    prefetchRow(pSrcY + srcPitchY + x, pSrcU + srcPitchUV + x / subsamplingX, pSrcV + srcPitchUV + x / subsamplingX);
+
+                Vec8us result = zero_si128();
+
+                const auto srcY_v = Vec8us().load(pSrcY + x);
+                Vec8us srcU_v, srcV_v;
+
+                if constexpr (subsamplingX == 2)
+                {
+                    srcU_v = Vec8us().loadl(pSrcU + x / subsamplingX);
+                    srcU_v = blend8<0, 8, 1, 9, 2, 10, 3, 11>(srcU_v, srcU_v);
+                    srcV_v = Vec8us().loadl(pSrcV + x / subsamplingX);
+                    srcV_v = blend8<0, 8, 1, 9, 2, 10, 3, 11>(srcV_v, srcV_v);
+                }
+                else
+                {
+                    srcU_v = Vec8us().load(pSrcU + x);
+                    srcV_v = Vec8us().load(pSrcV + x);
+                }
+
+                // Backwards, so the first matching color is written last.
+                for (size_t i = colors.size(); i-- > 0;)
+                {
+                    const auto colorVector_y = Vec8us(colors.Y[i]);
+                    const auto colorVector_u = Vec8us(colors.U[i]);
+                    const auto colorVector_v = Vec8us(colors.V[i]);
+                    /* absolute difference */
+                    const auto diff_y = max(srcY_v, colorVector_y) - min(srcY_v, colorVector_y);
+                    const auto diff_u = max(srcU_v, colorVector_u) - min(srcU_v, colorVector_u);
+                    const auto diff_v = max(srcV_v, colorVector_v) - min(srcV_v, colorVector_v);
+
+                    if constexpr (euclid)
+                    {
+                        const auto pass = euclidPass(diff_y, diff_u, diff_v, wy, wu, wv, Vec2q(colors.radius2[i]));
+                        result = (pass & Vec8us(static_cast<T>(i + 1))) | (result & ~pass);
+                    }
+                    else
+                        result = select((diff_y < Vec8us(colors.tolY[i])) & (diff_u < Vec8us(colors.tolU[i])) & (diff_v < Vec8us(colors.tolV[i])), Vec8us(static_cast<T>(i + 1)), result);
+                }
+
+                storeMask(result, pDstY + x, stream);
+            }
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+
+    if (stream)
+        _mm_sfence();
+}
+
+
+// processPacked(): count U V pairs of a row to the U and V planes.
+// The even samples are packed with truncation, the odd ones after a shift by the sample size.
+template <typename T>
+void deinterleaveUVSse2(T* __restrict dstU, T* __restrict dstV, const T* src, int count) noexcept
+{
+    using V = std::conditional_t<std::is_same_v<T, uint8_t>, Vec8us, Vec4ui>;
+    constexpr int step = 16 / sizeof(T);
+    constexpr int shift = sizeof(T) * 8;
+    int x = 0;
+
+    for (; x + step <= count; x += step)
+    {
+        const V a = V().load(src + x * 2);
+        const V b = V().load(src + x * 2 + step);
+
+        compress(a, b).store(dstU + x);
+        compress(a >> shift, b >> shift).store(dstV + x);
+    }
+
+    for (; x < count; ++x)
+    {
+        dstU[x] = src[x * 2];
+        dstV[x] = src[x * 2 + 1];
+    }
+}
+
+// processPacked(): count Y0 U Y1 V groups of a row to the Y, U and V planes.
+// The even bytes are the luma, the odd ones U V pairs deinterleaved again.
+void deinterleaveYUY2Sse2(uint8_t* __restrict dstY, uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept
+{
+    constexpr int step = 16;
+    int x = 0;
+
+    for (; x + step <= count; x += step)
+    {
+        const Vec8us a = Vec8us().load(src + x * 4);
+        const Vec8us b = Vec8us().load(src + x * 4 + step);
+        const Vec8us c = Vec8us().load(src + x * 4 + step * 2);
+        const Vec8us d = Vec8us().load(src + x * 4 + step * 3);
+
+        compress(a, b).store(dstY + x * 2);
+        compress(c, d).store(dstY + x * 2 + step);
+
+        const Vec8us uv0 = __m128i(compress(a >> 8, b >> 8));
+        const Vec8us uv1 = __m128i(compress(c >> 8, d >> 8));
+
+        compress(uv0, uv1).store(dstU + x);
+        compress(uv0 >> 8, uv1 >> 8).store(dstV + x);
+    }
+
+    for (; x < count; ++x)
+    {
+        dstY[x * 2] = src[x * 4];
+        dstU[x] = src[x * 4 + 1];
+        dstY[x * 2 + 1] = src[x * 4 + 2];
+        dstV[x] = src[x * 4 + 3];
+    }
+}
+
+
+// hashPlane() rows: the XXH3 style accumulation of the 64-byte stripes of every row, then the row scramble.
+// Stripe i is salted with i * salt, the last one is zero padded. Same result as the C version.
+void hashRowsSse2(uint64_t* acc, const uint8_t* row, int row_size, int height, int pitch, const uint64_t* secret, uint64_t salt) noexcept
+{
+    constexpr int parts = 4;
+    __m128i acc_v[parts], secret_v[parts];
+    for (int j = 0; j < parts; ++j)
+    {
+        acc_v[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + j);
+        secret_v[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + j);
+    }
+
+    const __m128i prime = _mm_set1_epi64x(0x9E3779B1);
+    const int stripes = row_size / 64;
+    const int tail = row_size % 64;
+
+    auto accumulate = [&](const uint8_t* stripe, uint64_t stripe_salt)
+    {
+        const __m128i salt_v = _mm_set1_epi64x(static_cast<long long>(stripe_salt));
+
+        for (int j = 0; j < parts; ++j)
+        {
+            const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe) + j);
+            const __m128i key = _mm_xor_si128(_mm_xor_si128(data, secret_v[j]), salt_v);
+            // acc[i ^ 1] += data[i]
+            acc_v[j] = _mm_add_epi64(acc_v[j], _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+            acc_v[j] = _mm_add_epi64(acc_v[j], _mm_mul_epu32(key, _mm_srli_epi64(key, 32)));
+        }
+    };
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int i = 0; i < stripes; ++i)
+            accumulate(row + i * 64, i * salt);
+
+        if (tail)
+        {
+            alignas(64) uint8_t last[64] = {};
+            memcpy(last, row + stripes * 64, tail);
+            accumulate(last, stripes * salt);
+        }
+
+        for (int j = 0; j < parts; ++j)
+        {
+            __m128i a = _mm_xor_si128(acc_v[j], _mm_srli_epi64(acc_v[j], 47));
+            a = _mm_xor_si128(a, secret_v[j]);
+            // 64 x 32-bit multiply from the low and high halves.
+            acc_v[j] = _mm_add_epi64(_mm_mul_epu32(a, prime), _mm_slli_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), prime), 32));
+        }
+
+        row += pitch;
+    }
+
+    for (int j = 0; j < parts; ++j)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + j, acc_v[j]);
+}
+
+template void processSse2<uint8_t, 1, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 1, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 1, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 1, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 1, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 1, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 1, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 1, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 1, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 2, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 2, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 2, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 2, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 2, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 2, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 2, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSse2<uint8_t, 2, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processSse2<uint16_t, 1, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 1, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 1, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 1, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 1, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 1, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 1, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 1, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 1, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 2, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 2, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 2, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 2, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 2, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 2, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 2, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSse2<uint16_t, 2, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processEuclidSse2<uint8_t, 1, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 1, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 1, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 1, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 1, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 1, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 1, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 1, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 1, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 2, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 2, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 2, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 2, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 2, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 2, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 2, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processEuclidSse2<uint8_t, 2, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processEuclidSse2<uint16_t, 1, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 1, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 1, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 1, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 1, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 1, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 1, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 1, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 1, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 2, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 2, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 2, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 2, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 2, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 2, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 2, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 2, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 2, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 1, 0>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 1, 1>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 1, 2>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 1, 3>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 1, 4>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 1, 5>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 1, 6>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 1, 7>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processEuclidSse2<uint16_t, 2, 1, 8>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processSoftSse2<uint8_t, 1, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSoftSse2<uint8_t, 2, 2, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSoftSse2<uint8_t, 2, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processSoftSse2<uint8_t, 1, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSoftSse2<uint8_t, 2, 2, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processSoftSse2<uint8_t, 2, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processSoftSse2<uint16_t, 1, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSoftSse2<uint16_t, 2, 2, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSoftSse2<uint16_t, 2, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processSoftSse2<uint16_t, 1, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSoftSse2<uint16_t, 2, 2, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processSoftSse2<uint16_t, 2, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processIndexSse2<uint8_t, 1, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processIndexSse2<uint8_t, 2, 2, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processIndexSse2<uint8_t, 2, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processIndexSse2<uint8_t, 1, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processIndexSse2<uint8_t, 2, 2, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+template void processIndexSse2<uint8_t, 2, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint8_t>& colors) noexcept;
+
+template void processIndexSse2<uint16_t, 1, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processIndexSse2<uint16_t, 2, 2, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processIndexSse2<uint16_t, 2, 1, false>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void processIndexSse2<uint16_t, 1, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processIndexSse2<uint16_t, 2, 2, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+template void processIndexSse2<uint16_t, 2, 1, true>(void* __restrict pDstY, const void* pSrcY, const void* pSrcV, const void* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height, const YUVColors<uint16_t>& colors) noexcept;
+
+template void deinterleaveUVSse2<uint8_t>(uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept;
+template void deinterleaveUVSse2<uint16_t>(uint16_t* __restrict dstU, uint16_t* __restrict dstV, const uint16_t* src, int count) noexcept;
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <array>
+#include <immintrin.h>
+
+#include "tcolormask_core.h"
+
+// 256 entry byte lookup: vpermi2b looks up 128 entries, bit 7 of the index selects the half.
+static inline __m512i lookup(const __m512i* lut, __m512i index) noexcept
+{
+    const __m512i low = _mm512_permutex2var_epi8(lut[0], index, lut[1]);
+    const __m512i high = _mm512_permutex2var_epi8(lut[2], index, lut[3]);
+
+    return _mm512_mask_blend_epi8(_mm512_movepi8_mask(index), low, high);
+}
+
+// Per-plane LUTs of 8-bit with vpermi2b. Any width: the last vector of a row uses masked loads and stores.
+template <int subsamplingX, int subsamplingY>
+void processLutVbmi(uint8_t* __restrict pDstY, const uint8_t* pSrcY, const uint8_t* pSrcV, const uint8_t* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height,
+    const TColorMaskContext<uint8_t>& ctx) noexcept
+{
+    __m512i tableY[4], tableU[4], tableV[4];
+
+    for (int i = 0; i < 4; ++i)
+    {
+        tableY[i] = _mm512_loadu_si512(ctx.lutY + i * 64);
+        tableU[i] = _mm512_loadu_si512(ctx.lutU + i * 64);
+        tableV[i] = _mm512_loadu_si512(ctx.lutV + i * 64);
+    }
+
+    // 4:2:x: every chroma byte covers two luma bytes.
+    const __m512i upsample = _mm512_set_epi8(
+        31, 31, 30, 30, 29, 29, 28, 28, 27, 27, 26, 26, 25, 25, 24, 24, 23, 23, 22, 22, 21, 21, 20, 20, 19, 19, 18, 18, 17, 17, 16, 16,
+        15, 15, 14, 14, 13, 13, 12, 12, 11, 11, 10, 10, 9, 9, 8, 8, 7, 7, 6, 6, 5, 5, 4, 4, 3, 3, 2, 2, 1, 1, 0, 0);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; x += 64)
+        {
+            const int count = std::min(width - x, 64);
+            const __mmask64 mask = (count == 64) ? ~0ull : (1ull << count) - 1;
+            const __mmask64 mask_uv = (subsamplingX == 2) ? (1ull << (count + 1) / 2) - 1 : mask;
+
+            const __m512i srcY = _mm512_maskz_loadu_epi8(mask, pSrcY + x);
+            __m512i srcU = _mm512_maskz_loadu_epi8(mask_uv, pSrcU + x / subsamplingX);
+            __m512i srcV = _mm512_maskz_loadu_epi8(mask_uv, pSrcV + x / subsamplingX);
+
+            if constexpr (subsamplingX == 2)
+            {
+                srcU = _mm512_permutexvar_epi8(upsample, srcU);
+                srcV = _mm512_permutexvar_epi8(upsample, srcV);
+            }
+
+            const __m512i result = _mm512_and_si512(_mm512_and_si512(lookup(tableY, srcY), lookup(tableU, srcU)), lookup(tableV, srcV));
+            _mm512_mask_storeu_epi8(pDstY + x, mask, result);
+        }
+
+        pSrcY += srcPitchY;
+
+        if (y % subsamplingY == (subsamplingY - 1))
+        {
+            pSrcU += srcPitchUV;
+            pSrcV += srcPitchUV;
+        }
+
+        pDstY += dstPitchY;
+    }
+}
+
+
+// Byte indices 0, 2, 4, .. 126 of the concatenation of two vectors.
+alignas(64) static constexpr auto even_bytes = []
+{
+    std::array<uint8_t, 64> indices{};
+    for (int i = 0; i < 64; ++i)
+        indices[i] = static_cast<uint8_t>(i * 2);
+    return indices;
+}();
+
+// processPacked(): count U V pairs of a row to the U and V planes, vpermt2b picks the even and odd bytes of two vectors.
+void deinterleaveUVVbmi(uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept
+{
+    const __m512i even = _mm512_load_si512(even_bytes.data());
+    const __m512i odd = _mm512_add_epi8(even, _mm512_set1_epi8(1));
+    int x = 0;
+
+    for (; x + 64 <= count; x += 64)
+    {
+        const __m512i a = _mm512_loadu_si512(src + x * 2);
+        const __m512i b = _mm512_loadu_si512(src + x * 2 + 64);
+
+        _mm512_storeu_si512(dstU + x, _mm512_permutex2var_epi8(a, even, b));
+        _mm512_storeu_si512(dstV + x, _mm512_permutex2var_epi8(a, odd, b));
+    }
+
+    for (; x < count; ++x)
+    {
+        dstU[x] = src[x * 2];
+        dstV[x] = src[x * 2 + 1];
+    }
+}
+
+// processPacked(): count Y0 U Y1 V groups of a row to the Y, U and V planes.
+// The even bytes are the luma, the odd ones U V pairs deinterleaved again.
+void deinterleaveYUY2Vbmi(uint8_t* __restrict dstY, uint8_t* __restrict dstU, uint8_t* __restrict dstV, const uint8_t* src, int count) noexcept
+{
+    const __m512i even = _mm512_load_si512(even_bytes.data());
+    const __m512i odd = _mm512_add_epi8(even, _mm512_set1_epi8(1));
+    int x = 0;
+
+    for (; x + 64 <= count; x += 64)
+    {
+        const __m512i a = _mm512_loadu_si512(src + x * 4);
+        const __m512i b = _mm512_loadu_si512(src + x * 4 + 64);
+        const __m512i c = _mm512_loadu_si512(src + x * 4 + 128);
+        const __m512i d = _mm512_loadu_si512(src + x * 4 + 192);
+
+        _mm512_storeu_si512(dstY + x * 2, _mm512_permutex2var_epi8(a, even, b));
+        _mm512_storeu_si512(dstY + x * 2 + 64, _mm512_permutex2var_epi8(c, even, d));
+
+        const __m512i uv0 = _mm512_permutex2var_epi8(a, odd, b);
+        const __m512i uv1 = _mm512_permutex2var_epi8(c, odd, d);
+
+        _mm512_storeu_si512(dstU + x, _mm512_permutex2var_epi8(uv0, even, uv1));
+        _mm512_storeu_si512(dstV + x, _mm512_permutex2var_epi8(uv0, odd, uv1));
+    }
+
+    for (; x < count; ++x)
+    {
+        dstY[x * 2] = src[x * 4];
+        dstU[x] = src[x * 4 + 1];
+        dstY[x * 2 + 1] = src[x * 4 + 2];
+        dstV[x] = src[x * 4 + 3];
+    }
+}
+
+template void processLutVbmi<1, 1>(uint8_t* __restrict pDstY, const uint8_t* pSrcY, const uint8_t* pSrcV, const uint8_t* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height,
+    const TColorMaskContext<uint8_t>& ctx) noexcept;
+template void processLutVbmi<2, 2>(uint8_t* __restrict pDstY, const uint8_t* pSrcY, const uint8_t* pSrcV, const uint8_t* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height,
+    const TColorMaskContext<uint8_t>& ctx) noexcept;
+template void processLutVbmi<2, 1>(uint8_t* __restrict pDstY, const uint8_t* pSrcY, const uint8_t* pSrcV, const uint8_t* pSrcU, int dstPitchY, int srcPitchY, int srcPitchUV, int width, int height,
+    const TColorMaskContext<uint8_t>& ctx) noexcept;
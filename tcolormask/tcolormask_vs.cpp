@@ -0,0 +1,352 @@
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+#include "VapourSynth4.h"
+#include "tcolormask_core.h"
+
+template <typename T>
+struct TColorMaskData
+{
+    VSNode* node;
+    VSVideoInfo vi;
+    std::unique_ptr<TColorMaskEngines<T>> engines;
+    bool grayscale;
+    // output="alpha": format of the mask attached to the source frame as _Alpha.
+    bool alpha;
+    VSVideoFormat alpha_format;
+    // chroma="copy": the chroma planes of the output are the ones of the source frame.
+    bool copy_chroma;
+};
+
+template <typename T>
+static const TColorMaskCore<T>* const* engine(TColorMaskEngines<T>& engines, const VSFrame* src, const VSAPI* vsapi)
+{
+    const VSMap* props{ vsapi->getFramePropertiesRO(src) };
+    int err;
+    int64_t matrix{ vsapi->mapGetInt(props, "_Matrix", 0, &err) };
+    if (err)
+        matrix = -1;
+    int64_t range{ vsapi->mapGetInt(props, "_ColorRange", 0, &err) };
+    if (err)
+        range = -1;
+
+    return engines.get(static_cast<int>(matrix), static_cast<int>(range));
+}
+
+template <typename T>
+static const VSFrame* VS_CC tcolormaskGetFrame(int n, int activationReason, void* instanceData, [[maybe_unused]] void** frameData, VSFrameContext* frameCtx, VSCore* core, const VSAPI* vsapi)
+{
+    auto d{ static_cast<TColorMaskData<T>*>(instanceData) };
+
+    if (activationReason == arInitial)
+        vsapi->requestFrameFilter(n, d->node, frameCtx);
+    else if (activationReason == arAllFramesReady)
+    {
+        const VSFrame* src{ vsapi->getFrameFilter(n, d->node, frameCtx) };
+        // The planes of the source frame are shared, only the mask is allocated.
+        VSFrame* dst;
+
+        if (d->alpha)
+            dst = vsapi->newVideoFrame(&d->alpha_format, d->vi.width, d->vi.height, nullptr, core);
+        else if (d->copy_chroma)
+        {
+            const VSFrame* plane_src[3]{ nullptr, src, src };
+            const int planes[3]{ 0, 1, 2 };
+            dst = vsapi->newVideoFrame2(&d->vi.format, d->vi.width, d->vi.height, plane_src, planes, src, core);
+        }
+        else
+            dst = vsapi->newVideoFrame(&d->vi.format, d->vi.width, d->vi.height, src, core);
+
+        const int groups{ d->engines->groups() };
+
+        // The engine of the frame's matrix/range is built on first use, which can throw.
+        try
+        {
+            T* dst_ptrs[3];
+            int dst_pitches[3];
+
+            for (int i = 0; i < groups; ++i)
+            {
+                dst_ptrs[i] = reinterpret_cast<T*>(vsapi->getWritePtr(dst, i));
+                dst_pitches[i] = static_cast<int>(vsapi->getStride(dst, i) / sizeof(T));
+            }
+
+            const YUVPlanes<T> src_planes{ reinterpret_cast<const T*>(vsapi->getReadPtr(src, 0)),
+                reinterpret_cast<const T*>(vsapi->getReadPtr(src, 1)),
+                reinterpret_cast<const T*>(vsapi->getReadPtr(src, 2)),
+                static_cast<int>(vsapi->getStride(src, 0) / sizeof(T)),
+                static_cast<int>(vsapi->getStride(src, 1) / sizeof(T)) };
+
+            TColorMaskCore<T>::processGroups(engine(*d->engines, src, vsapi), groups, dst_ptrs, dst_pitches, src_planes);
+        }
+        catch (const std::exception& e)
+        {
+            vsapi->setFilterError(e.what(), frameCtx);
+            vsapi->freeFrame(src);
+            vsapi->freeFrame(dst);
+
+            return nullptr;
+        }
+
+        if (groups == 2)
+            memset(vsapi->getWritePtr(dst, 2), 0, vsapi->getStride(dst, 2) * vsapi->getFrameHeight(dst, 2));
+
+        if (d->grayscale)
+        {
+            for (int plane = 1; plane < 3; ++plane)
+                memset(vsapi->getWritePtr(dst, plane), 128, vsapi->getStride(dst, plane) * vsapi->getFrameHeight(dst, plane));
+        }
+
+        if (d->alpha)
+        {
+            VSFrame* out{ vsapi->copyFrame(src, core) };
+            vsapi->mapConsumeFrame(vsapi->getFramePropertiesRW(out), "_Alpha", dst, maReplace);
+            vsapi->freeFrame(src);
+
+            return out;
+        }
+
+        vsapi->freeFrame(src);
+
+        return dst;
+    }
+
+    return nullptr;
+}
+
+template <typename T>
+static void VS_CC tcolormaskFree(void* instanceData, [[maybe_unused]] VSCore* core, const VSAPI* vsapi)
+{
+    auto d{ static_cast<TColorMaskData<T>*>(instanceData) };
+    vsapi->freeNode(d->node);
+    delete d;
+}
+
+template <typename T>
+static void createFilter(VSMap* out, VSNode* node, const TColorMaskParams& params, bool forceMatrix, bool grayscale, bool onlyY, bool alpha, bool copyChroma, VSCore* core, const VSAPI* vsapi)
+{
+    auto d{ std::make_unique<TColorMaskData<T>>() };
+    d->node = node;
+    d->vi = *vsapi->getVideoInfo(node);
+    d->grayscale = grayscale;
+    d->alpha = alpha;
+    d->copy_chroma = copyChroma;
+    d->engines = std::make_unique<TColorMaskEngines<T>>(params, forceMatrix);
+
+    // fill=false: the clip is cropped to the region of interest.
+    if (!params.roiFill)
+    {
+        if (alpha || copyChroma)
+            throw std::runtime_error("tcolormask: fill=false cannot be used with output=\"alpha\" and chroma=\"copy\".");
+
+        const TColorMaskCore<T>& core{ *d->engines->get(-1, -1)[0] };
+        d->vi.width = core.roiWidth();
+        d->vi.height = core.roiHeight();
+    }
+
+    // Convert the colors for the matrix/range of the first frame up front.
+    if (const VSFrame* frame{ vsapi->getFrame(0, node, nullptr, 0) })
+    {
+        engine(*d->engines, frame, vsapi);
+        vsapi->freeFrame(frame);
+    }
+
+    if (alpha)
+    {
+        if (d->engines->groups() > 1)
+            throw std::runtime_error("tcolormask: output=\"alpha\" cannot be used with several color groups.");
+
+        vsapi->queryVideoFormat(&d->alpha_format, cfGray, stInteger, d->vi.format.bitsPerSample, 0, 0, core);
+    }
+    // Several color groups: one full size plane per group.
+    else if (d->engines->groups() > 1)
+    {
+        if (onlyY || grayscale || copyChroma)
+            throw std::runtime_error("tcolormask: onlyY, gray and chroma=\"copy\" cannot be used with several color groups.");
+
+        vsapi->queryVideoFormat(&d->vi.format, (params.rgb) ? cfRGB : cfYUV, stInteger, d->vi.format.bitsPerSample, 0, 0, core);
+    }
+
+    // The mask of RGB clips is returned as Gray.
+    if (!alpha && (onlyY || (params.rgb && d->engines->groups() == 1)))
+        vsapi->queryVideoFormat(&d->vi.format, cfGray, stInteger, d->vi.format.bitsPerSample, 0, 0, core);
+
+    VSFilterDependency deps[]{ { node, rpStrictSpatial } };
+    vsapi->createVideoFilter(out, "TColorMask", &d->vi, tcolormaskGetFrame<T>, tcolormaskFree<T>, fmParallel, deps, 1, d.get(), core);
+    d.release();
+}
+
+static void VS_CC tcolormaskCreate(const VSMap* in, VSMap* out, [[maybe_unused]] void* userData, VSCore* core, const VSAPI* vsapi)
+{
+    VSNode* node{ vsapi->mapGetNode(in, "clip", 0, nullptr) };
+    const VSVideoInfo* vi{ vsapi->getVideoInfo(node) };
+
+    try
+    {
+        const int bits{ vi->format.bitsPerSample };
+
+        if ((vi->format.colorFamily != cfYUV && vi->format.colorFamily != cfRGB) || vi->format.sampleType != stInteger || (bits != 8 && bits != 16))
+            throw std::runtime_error("tcolormask: only 8 and 16-bit YUV and RGB supported.");
+        if (vi->width == 0 || vi->height == 0)
+            throw std::runtime_error("tcolormask: only constant format supported.");
+
+        int err;
+        const char* colors_data{ vsapi->mapGetData(in, "colors", 0, &err) };
+        const std::string_view colors{ (err) ? std::string_view() : std::string_view(colors_data, vsapi->mapGetDataSize(in, "colors", 0, nullptr)) };
+
+        TColorMaskParams params;
+        params.width = vi->width;
+        params.height = vi->height;
+        params.subsamplingX = 1 << vi->format.subSamplingW;
+        params.subsamplingY = 1 << vi->format.subSamplingH;
+        params.rgb = vi->format.colorFamily == cfRGB;
+
+        const char* space_data{ vsapi->mapGetData(in, "space", 0, &err) };
+        const std::string_view space{ (err) ? std::string_view("rgb") : std::string_view(space_data, vsapi->mapGetDataSize(in, "space", 0, nullptr)) };
+        if (space != "rgb" && space != "yuv")
+            throw std::runtime_error("tcolormask: space must be rgb or yuv.");
+
+        // space="yuv": colors and colorfile are already Y/U/V triplets.
+        std::vector<TColorMaskColor>& packed{ (space == "yuv") ? params.yuvColors : params.colors };
+        parseColors(colors, bits, packed);
+
+        const char* colorfile{ vsapi->mapGetData(in, "colorfile", 0, &err) };
+        if (!err)
+        {
+            const auto palette{ loadPalette(colorfile, bits) };
+            packed.insert(packed.end(), palette->begin(), palette->end());
+        }
+
+        const char* yuvcolors_data{ vsapi->mapGetData(in, "yuvcolors", 0, &err) };
+        if (!err)
+            parseColors(std::string_view(yuvcolors_data, vsapi->mapGetDataSize(in, "yuvcolors", 0, nullptr)), bits, params.yuvColors);
+
+        const char* metric_data{ vsapi->mapGetData(in, "metric", 0, &err) };
+        const std::string_view metric{ (err) ? std::string_view("box") : std::string_view(metric_data, vsapi->mapGetDataSize(in, "metric", 0, nullptr)) };
+        if (metric != "box" && metric != "euclid")
+            throw std::runtime_error("tcolormask: metric must be box or euclid.");
+
+        params.euclid = metric == "euclid";
+
+        params.weightY = vsapi->mapGetIntSaturated(in, "wy", 0, &err);
+        if (err)
+            params.weightY = 1;
+        params.weightU = vsapi->mapGetIntSaturated(in, "wu", 0, &err);
+        if (err)
+            params.weightU = 4;
+        params.weightV = vsapi->mapGetIntSaturated(in, "wv", 0, &err);
+        if (err)
+            params.weightV = 4;
+
+        params.soft = !!vsapi->mapGetInt(in, "soft", 0, &err);
+
+        const char* mode_data{ vsapi->mapGetData(in, "mode", 0, &err) };
+        const std::string_view mode{ (err) ? std::string_view("mask") : std::string_view(mode_data, vsapi->mapGetDataSize(in, "mode", 0, nullptr)) };
+        if (mode != "mask" && mode != "index")
+            throw std::runtime_error("tcolormask: mode must be mask or index.");
+
+        params.index = mode == "index";
+
+        const char* output_data{ vsapi->mapGetData(in, "output", 0, &err) };
+        const std::string_view output{ (err) ? std::string_view("mask") : std::string_view(output_data, vsapi->mapGetDataSize(in, "output", 0, nullptr)) };
+        if (output != "mask" && output != "alpha")
+            throw std::runtime_error("tcolormask: output must be mask or alpha.");
+
+        const bool alpha{ output == "alpha" };
+
+        const char* chroma_data{ vsapi->mapGetData(in, "chroma", 0, &err) };
+        const std::string_view chroma{ (err) ? std::string_view("none") : std::string_view(chroma_data, vsapi->mapGetDataSize(in, "chroma", 0, nullptr)) };
+        if (chroma != "none" && chroma != "copy")
+            throw std::runtime_error("tcolormask: chroma must be none or copy.");
+
+        const bool copyChroma{ chroma == "copy" };
+
+        params.tolerance = vsapi->mapGetIntSaturated(in, "tolerance", 0, &err);
+        if (err)
+            params.tolerance = -1;
+
+        params.matrix = (vsapi->mapGetInt(in, "bt601", 0, &err)) ? 6 : 1;
+        const bool forceMatrix{ !err };
+
+        params.lutthr = vsapi->mapGetIntSaturated(in, "lutthr", 0, &err);
+        if (err)
+            params.lutthr = 9;
+
+        params.mt = !!vsapi->mapGetInt(in, "mt", 0, &err);
+
+        params.opt = vsapi->mapGetIntSaturated(in, "opt", 0, &err);
+        if (err)
+            params.opt = -1;
+
+        params.stream = vsapi->mapGetIntSaturated(in, "stream", 0, &err);
+        if (err)
+            params.stream = -1;
+
+        params.roiLeft = vsapi->mapGetIntSaturated(in, "left", 0, &err);
+        params.roiTop = vsapi->mapGetIntSaturated(in, "top", 0, &err);
+        params.roiWidth = vsapi->mapGetIntSaturated(in, "width", 0, &err);
+        params.roiHeight = vsapi->mapGetIntSaturated(in, "height", 0, &err);
+
+        params.roiFill = !!vsapi->mapGetInt(in, "fill", 0, &err);
+        if (err)
+            params.roiFill = true;
+
+        const bool grayscale{ !!vsapi->mapGetInt(in, "gray", 0, &err) };
+        const bool onlyY{ !!vsapi->mapGetInt(in, "onlyY", 0, &err) };
+
+        if (grayscale && onlyY)
+            throw std::runtime_error("tcolormask: both grayscale and onlyY cannot be true in the same time.");
+        if (grayscale && params.rgb)
+            throw std::runtime_error("tcolormask: gray cannot be used with RGB clips.");
+        if (alpha && (onlyY || grayscale))
+            throw std::runtime_error("tcolormask: output=\"alpha\" cannot be used with onlyY and gray.");
+        if (copyChroma && (alpha || params.rgb || onlyY || grayscale))
+            throw std::runtime_error("tcolormask: chroma=\"copy\" cannot be used with output=\"alpha\", RGB clips, onlyY and gray.");
+
+        if (bits == 8)
+            createFilter<uint8_t>(out, node, params, forceMatrix, grayscale, onlyY, alpha, copyChroma, core, vsapi);
+        else
+            createFilter<uint16_t>(out, node, params, forceMatrix, grayscale, onlyY, alpha, copyChroma, core, vsapi);
+    }
+    catch (const std::exception& e)
+    {
+        vsapi->mapSetError(out, e.what());
+        vsapi->freeNode(node);
+    }
+}
+
+VS_EXTERNAL_API(void) VapourSynthPluginInit2(VSPlugin* plugin, const VSPLUGINAPI* vspapi)
+{
+    vspapi->configPlugin("com.asd-g.tcolormask", "tcm", "Masks colors", VS_MAKE_VERSION(1, 3), VAPOURSYNTH_API_VERSION, 0, plugin);
+    vspapi->registerFunction("TColorMask",
+        "clip:vnode;"
+        "colors:data:opt;"
+        "tolerance:int:opt;"
+        "bt601:int:opt;"
+        "gray:int:opt;"
+        "lutthr:int:opt;"
+        "mt:int:opt;"
+        "onlyY:int:opt;"
+        "opt:int:opt;"
+        "left:int:opt;"
+        "top:int:opt;"
+        "width:int:opt;"
+        "height:int:opt;"
+        "fill:int:opt;"
+        "colorfile:data:opt;"
+        "yuvcolors:data:opt;"
+        "space:data:opt;"
+        "metric:data:opt;"
+        "wy:int:opt;"
+        "wu:int:opt;"
+        "wv:int:opt;"
+        "soft:int:opt;"
+        "mode:data:opt;"
+        "output:data:opt;"
+        "chroma:data:opt;"
+        "stream:int:opt;",
+        "clip:vnode;",
+        tcolormaskCreate, nullptr, plugin);
+}
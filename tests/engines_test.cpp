@@ -0,0 +1,139 @@
+// Checks the engine selection from _Matrix/_ColorRange: each matrix and range converts the RGB colors with its own
+// coefficients, unsupported and missing values fall back to the defaults, forceMatrix ignores _Matrix, engines are
+// built once and YUV colors and RGB clips don't depend on the frame properties.
+
+#include <algorithm>
+
+#include "tcolormask_test.h"
+
+// Pure red in the matrices and ranges, 8-bit. Each engine must select its own conversion only.
+struct Red
+{
+    const char* name;
+    int matrix;
+    int range;
+    int y;
+    int u;
+    int v;
+};
+
+static constexpr Red reds[] = {
+    { "BT.709 limited", 1, 1, 63, 102, 240 },
+    { "BT.709 full", 1, 0, 54, 99, 255 },
+    { "BT.601 limited", 6, 1, 81, 90, 240 },
+    { "BT.601 full", 6, 0, 76, 85, 255 },
+};
+
+static constexpr int count = sizeof(reds) / sizeof(reds[0]);
+static constexpr int region = 16;
+static constexpr int width = region * count;
+
+template <typename T>
+static T scale(int x, bool full) noexcept
+{
+    return static_cast<T>((sizeof(T) == 1) ? x : (full) ? x * 257 : x << 8);
+}
+
+// One region of the frame per conversion of red. Returns a bit per region fully masked by the engine.
+template <typename T>
+static int masked(const TColorMaskCore<T>* core)
+{
+    std::vector<T> Y(width), U(width), V(width), dst(width);
+
+    for (int x = 0; x < width; ++x)
+    {
+        const Red& r = reds[x / region];
+        Y[x] = scale<T>(r.y, r.range == 0);
+        U[x] = scale<T>(r.u, r.range == 0);
+        V[x] = scale<T>(r.v, r.range == 0);
+    }
+
+    core->process(dst.data(), Y.data(), U.data(), V.data(), width, width, width);
+
+    int regions = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (std::all_of(dst.begin() + i * region, dst.begin() + (i + 1) * region, [](T x) { return x != 0; }))
+            regions |= 1 << i;
+    }
+
+    return regions;
+}
+
+template <typename T>
+static TColorMaskParams redParams()
+{
+    TColorMaskParams params;
+    params.width = width;
+    params.height = 1;
+    params.colors.push_back({ (sizeof(T) == 1) ? 0xFF0000 : 0xFFFF00000000 });
+    params.tolerance = (sizeof(T) == 1) ? 6 : 6 * 257;
+
+    return params;
+}
+
+template <typename T>
+static void run()
+{
+    constexpr int bits = sizeof(T) * 8;
+
+    {
+        TColorMaskEngines<T> engines(redParams<T>(), false);
+
+        for (int i = 0; i < count; ++i)
+            check(masked(engines.get(reds[i].matrix, reds[i].range)[0]) == 1 << i, "%d-bit %s: wrong conversion", bits, reds[i].name);
+
+        // Defaults: BT.709, limited range.
+        check(masked(engines.get(-1, -1)[0]) == 1, "%d-bit no properties: not BT.709 limited", bits);
+        check(masked(engines.get(2, -1)[0]) == 1, "%d-bit unspecified matrix: not BT.709 limited", bits);
+        check(masked(engines.get(-1, 0)[0]) == 2, "%d-bit full range without matrix: not BT.709 full", bits);
+        check(masked(engines.get(6, 2)[0]) == 4, "%d-bit invalid range: not BT.601 limited", bits);
+
+        check(engines.get(5, 1)[0] == engines.get(6, 1)[0], "%d-bit _Matrix=5 and 6: different engines", bits);
+        check(engines.get(10, 0)[0] == engines.get(9, 0)[0], "%d-bit _Matrix=10 and 9: different engines", bits);
+        check(engines.get(6, 0)[0] == engines.get(6, 0)[0], "%d-bit repeated properties: engine built again", bits);
+    }
+
+    {
+        TColorMaskParams params = redParams<T>();
+        params.matrix = 6;
+        params.fullRange = true;
+
+        TColorMaskEngines<T> engines(params, false);
+        check(masked(engines.get(-1, -1)[0]) == 8, "%d-bit matrix=6 fullRange: not BT.601 full", bits);
+        check(masked(engines.get(1, 1)[0]) == 1, "%d-bit matrix=6 fullRange: _Matrix=1 _ColorRange=1 ignored", bits);
+
+        TColorMaskEngines<T> forced(params, true);
+        check(masked(forced.get(1, -1)[0]) == 8, "%d-bit forceMatrix: _Matrix used", bits);
+        check(masked(forced.get(1, 1)[0]) == 4, "%d-bit forceMatrix: _ColorRange ignored", bits);
+    }
+
+    {
+        TColorMaskParams params = redParams<T>();
+        params.colors.clear();
+        params.yuvColors.push_back({ packColor(scale<T>(81, false), scale<T>(90, false), scale<T>(240, false)) });
+        params.yuvColors.push_back({ packColor(scale<T>(54, true), scale<T>(99, true), scale<T>(255, true)) });
+        params.yuvColors.back().group = 1;
+
+        TColorMaskEngines<T> engines(params, false);
+        const TColorMaskCore<T>* const* cores = engines.get(1, 0);
+        check(engines.groups() == 2, "%d-bit groups() = %d, expected 2", bits, engines.groups());
+        check(cores[0] == engines.get(-1, -1)[0], "%d-bit YUV colors: engine depends on the properties", bits);
+        check(masked(cores[0]) == 4 && masked(cores[1]) == 2, "%d-bit YUV colors in 2 groups: wrong masks", bits);
+
+        params = redParams<T>();
+        params.rgb = true;
+
+        TColorMaskEngines<T> rgb(params, false);
+        check(rgb.get(6, 0)[0] == rgb.get(-1, -1)[0], "%d-bit RGB clip: engine depends on the properties", bits);
+    }
+}
+
+int main()
+{
+    return runTest("engines_test", []
+    {
+        run<uint8_t>();
+        run<uint16_t>();
+    });
+}
@@ -0,0 +1,129 @@
+// Checks the source frame hash used by the mask cache: the SSE2 and AVX2 rows against the C algorithm, and the
+// properties the cache relies on. The cache itself is in the AviSynth frontend and isn't built without AviSynth.
+
+#include <algorithm>
+#include <cstring>
+
+#include "tcolormask_test.h"
+
+// The C version of hashPlane() rows, XXH3 style 64-byte stripes.
+static void hashRowsRef(uint64_t* acc, const uint8_t* row, int row_size, int height, int pitch, const uint64_t* secret, uint64_t salt)
+{
+    for (int y = 0; y < height; ++y)
+    {
+        for (int i = 0; i * 64 < row_size; ++i)
+        {
+            uint8_t stripe[64] = {};
+            memcpy(stripe, row + i * 64, std::min(64, row_size - i * 64));
+
+            for (int j = 0; j < 8; ++j)
+            {
+                uint64_t data;
+                memcpy(&data, stripe + j * 8, 8);
+                const uint64_t key = data ^ secret[j] ^ (i * salt);
+                acc[j ^ 1] += data;
+                acc[j] += (key & 0xFFFFFFFF) * (key >> 32);
+            }
+        }
+
+        for (int j = 0; j < 8; ++j)
+        {
+            acc[j] ^= acc[j] >> 47;
+            acc[j] ^= secret[j];
+            acc[j] *= 0x9E3779B1;
+        }
+
+        row += pitch;
+    }
+}
+
+static void testRows(int max_opt, std::mt19937& rng)
+{
+    uint64_t secret[8];
+    for (uint64_t& x : secret)
+        x = (static_cast<uint64_t>(rng()) << 32) | rng();
+    const uint64_t salt = 0x85EBCA77C2B2AE63ULL;
+
+    for (int row_size : { 0, 1, 7, 8, 63, 64, 65, 127, 128, 129, 200, 1920 })
+    {
+        constexpr int height = 5;
+        const int pitch = row_size + 13;
+        std::vector<uint8_t> plane(static_cast<size_t>(pitch) * height);
+        for (uint8_t& x : plane)
+            x = static_cast<uint8_t>(rng());
+
+        uint64_t ref[8];
+        for (int i = 0; i < 8; ++i)
+            ref[i] = rng();
+        uint64_t sse2[8], avx2[8];
+        memcpy(sse2, ref, sizeof(ref));
+        memcpy(avx2, ref, sizeof(ref));
+
+        hashRowsRef(ref, plane.data(), row_size, height, pitch, secret, salt);
+        hashRowsSse2(sse2, plane.data(), row_size, height, pitch, secret, salt);
+        check(memcmp(sse2, ref, sizeof(ref)) == 0, "hashRowsSse2() row_size=%d: differs from C", row_size);
+
+        if (max_opt >= 2)
+        {
+            hashRowsAvx2(avx2, plane.data(), row_size, height, pitch, secret, salt);
+            check(memcmp(avx2, ref, sizeof(ref)) == 0, "hashRowsAvx2() row_size=%d: differs from C", row_size);
+        }
+    }
+}
+
+static void testPlane(std::mt19937& rng)
+{
+    constexpr int row_size = 1923;
+    constexpr int height = 7;
+    constexpr int pitch = 1984;
+
+    std::vector<uint8_t> plane(static_cast<size_t>(pitch) * height);
+    for (uint8_t& x : plane)
+        x = static_cast<uint8_t>(rng());
+
+    const uint64_t hash = hashPlane(plane.data(), row_size, height, pitch, 0);
+    check(hashPlane(plane.data(), row_size, height, pitch, 0) == hash, "hashPlane(): not deterministic");
+
+    // Same pixels with another pitch: the padding isn't hashed.
+    std::vector<uint8_t> tight(static_cast<size_t>(row_size) * height);
+    for (int y = 0; y < height; ++y)
+        memcpy(tight.data() + y * row_size, plane.data() + y * pitch, row_size);
+    check(hashPlane(tight.data(), row_size, height, row_size, 0) == hash, "hashPlane(): depends on the pitch");
+
+    plane[pitch - 1] ^= 1;
+    check(hashPlane(plane.data(), row_size, height, pitch, 0) == hash, "hashPlane(): depends on the padding");
+    plane[pitch - 1] ^= 1;
+
+    // Any changed pixel, in the 64-byte stripes and in the tail of the rows.
+    for (int x : { 0, 1, 63, 64, 1000, 1919, 1920, 1922 })
+    {
+        for (int y : { 0, height - 1 })
+        {
+            plane[y * pitch + x] ^= 0x10;
+            check(hashPlane(plane.data(), row_size, height, pitch, 0) != hash, "hashPlane(): pixel (%d, %d) not hashed", x, y);
+            plane[y * pitch + x] ^= 0x10;
+        }
+    }
+
+    // Same rows in another order, and the same bytes as other dimensions.
+    std::vector<uint8_t> swapped = tight;
+    std::swap_ranges(swapped.begin(), swapped.begin() + row_size, swapped.begin() + row_size);
+    check(hashPlane(swapped.data(), row_size, height, row_size, 0) != hash, "hashPlane(): row order not hashed");
+    check(hashPlane(tight.data(), row_size * height, 1, row_size * height, 0) != hash, "hashPlane(): dimensions not hashed");
+
+    // Planes are chained through the seed.
+    const uint64_t chained = hashPlane(tight.data(), 64, 1, 64, hash);
+    check(chained != hashPlane(tight.data(), 64, 1, 64, 0), "hashPlane(): seed ignored");
+    check(chained != hashPlane(tight.data(), 64, 1, 64, hash ^ 1), "hashPlane(): seed bits ignored");
+}
+
+int main()
+{
+    return runTest("hash_test", []
+    {
+        std::mt19937 rng(1);
+
+        testRows(maxOpt(), rng);
+        testPlane(rng);
+    });
+}
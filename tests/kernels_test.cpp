@@ -0,0 +1,210 @@
+// Checks the kernels of every instruction set of the CPU against the C kernels (opt=0): 4:2:0, 4:2:2, 4:4:4 and RGB,
+// the box, euclid, soft and index modes, the color counts of the specialized, generic and LUT kernels, widths that
+// aren't multiples of the vector sizes and planes without padding (run with -fsanitize=address to catch over-reads).
+
+#include <algorithm>
+
+#include "tcolormask_test.h"
+
+struct Format
+{
+    const char* name;
+    int subsamplingX;
+    int subsamplingY;
+    bool rgb;
+};
+
+static constexpr Format formats[] = {
+    { "4:2:0", 2, 2, false },
+    { "4:2:2", 2, 1, false },
+    { "4:4:4", 1, 1, false },
+    { "RGB", 1, 1, true },
+};
+
+struct Mode
+{
+    const char* name;
+    bool euclid;
+    bool soft;
+    bool index;
+};
+
+static constexpr Mode modes[] = {
+    { "box", false, false, false },
+    { "euclid", true, false, false },
+    { "soft", false, true, false },
+    { "soft euclid", true, true, false },
+    { "index", false, false, true },
+    { "index euclid", true, false, true },
+};
+
+// 1..8: kernels specialized on the count, 9: generic kernels, 12: LUTs of the box and euclid modes (lutthr=9).
+static constexpr int color_counts[] = { 1, 3, 8, 9, 12 };
+
+// Below, around and above the 16..64 pixel vectors. Odd widths are used as is with 4:4:4 and RGB.
+static constexpr int widths[] = { 3, 15, 31, 35, 63, 67, 99, 127, 131, 271 };
+static constexpr int height = 8;
+
+template <typename T>
+struct Source
+{
+    std::vector<T> Y;
+    std::vector<T> U;
+    std::vector<T> V;
+    int width;
+    int pitchY;
+    int pitchUV;
+};
+
+// Planes of exactly pitch * height pixels, the last row ends at the end of the allocation.
+template <typename T>
+static Source<T> randomSource(const Format& f, int width, int pitchY, int pitchUV, std::mt19937& rng)
+{
+    Source<T> src{ {}, {}, {}, width, pitchY, pitchUV };
+
+    randomPlane(src.Y, static_cast<size_t>(pitchY) * height, rng);
+    randomPlane(src.U, static_cast<size_t>(pitchUV) * (height / f.subsamplingY), rng);
+    randomPlane(src.V, src.U.size(), rng);
+
+    return src;
+}
+
+// Colors of random source pixels, every third one with its own per-plane tolerances.
+template <typename T>
+static std::vector<TColorMaskColor> sourceColors(const Format& f, const Source<T>& src, int count, std::mt19937& rng)
+{
+    const int tolerance = (sizeof(T) == 1) ? 12 : 3072;
+    std::vector<TColorMaskColor> colors;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const int x = rng() % src.width;
+        const int y = rng() % height;
+        const size_t pos_uv = static_cast<size_t>(y / f.subsamplingY) * src.pitchUV + x / f.subsamplingX;
+
+        TColorMaskColor color{ packColor(src.Y[static_cast<size_t>(y) * src.pitchY + x], src.U[pos_uv], src.V[pos_uv]) };
+        if (i % 3 == 1)
+        {
+            color.tolY = tolerance * 2;
+            color.tolU = tolerance / 4;
+            color.tolV = tolerance;
+        }
+
+        colors.push_back(color);
+    }
+
+    return colors;
+}
+
+template <typename T>
+static TColorMaskParams makeParams(const Format& f, const Mode& m, const std::vector<TColorMaskColor>& colors, int width)
+{
+    TColorMaskParams params;
+    params.width = width;
+    params.height = height;
+    params.subsamplingX = f.subsamplingX;
+    params.subsamplingY = f.subsamplingY;
+    params.rgb = f.rgb;
+    params.euclid = m.euclid;
+    params.soft = m.soft;
+    params.index = m.index;
+    params.stream = 0;
+    params.tolerance = (sizeof(T) == 1) ? 12 : 3072;
+    // The colors of an RGB clip are compared as is, YUV colors are used without conversion.
+    if (f.rgb)
+        params.colors = colors;
+    else
+        params.yuvColors = colors;
+
+    return params;
+}
+
+// Tight planes and mask: pitches equal to the widths.
+template <typename T>
+static void runTight(const Format& f, const Mode& m, int count, int width, int max_opt, std::mt19937& rng)
+{
+    constexpr int bits = sizeof(T) * 8;
+    const Source<T> src = randomSource<T>(f, width, width, width / f.subsamplingX, rng);
+    TColorMaskParams params = makeParams<T>(f, m, sourceColors(f, src, count, rng), width);
+
+    std::vector<T> ref(static_cast<size_t>(width) * height);
+    params.opt = 0;
+    TColorMaskCore<T>(params).process(ref.data(), src.Y.data(), src.U.data(), src.V.data(), width, src.pitchY, src.pitchUV);
+    // The pixels of the colors match at least.
+    check(std::any_of(ref.begin(), ref.end(), [](T x) { return x != 0; }), "%d-bit %s %s %d colors width=%d: empty mask", bits, f.name, m.name, count, width);
+
+    for (int opt = 1; opt <= max_opt; ++opt)
+    {
+        std::vector<T> dst(ref.size());
+        params.opt = opt;
+        TColorMaskCore<T>(params).process(dst.data(), src.Y.data(), src.U.data(), src.V.data(), width, src.pitchY, src.pitchUV);
+
+        check(dst == ref, "%d-bit %s %s %d colors width=%d opt=%d: differs from opt=0", bits, f.name, m.name, count, width, opt);
+    }
+}
+
+// Padded source, 64-byte aligned mask rows with non-temporal stores and two threads.
+template <typename T>
+static void runStream(const Format& f, const Mode& m, int max_opt, std::mt19937& rng)
+{
+    constexpr int bits = sizeof(T) * 8;
+    const int width = (f.subsamplingX == 2) ? 270 : 271;
+    constexpr int dst_pitch = 320;
+    const Source<T> src = randomSource<T>(f, width, width + 37, width / f.subsamplingX + 21, rng);
+    TColorMaskParams params = makeParams<T>(f, m, sourceColors(f, src, 4, rng), width);
+
+    std::vector<T> ref(static_cast<size_t>(dst_pitch) * height);
+    params.opt = 0;
+    TColorMaskCore<T>(params).process(ref.data(), src.Y.data(), src.U.data(), src.V.data(), dst_pitch, src.pitchY, src.pitchUV);
+
+    AlignedArena arena;
+    arena.allocate(ref.size() * sizeof(T), false);
+    T* dst = reinterpret_cast<T*>(arena.data());
+
+    params.stream = 1;
+    params.mt = true;
+
+    for (int opt = 1; opt <= max_opt; ++opt)
+    {
+        params.opt = opt;
+        TColorMaskCore<T>(params).process(dst, src.Y.data(), src.U.data(), src.V.data(), dst_pitch, src.pitchY, src.pitchUV);
+
+        bool equal = true;
+        for (int y = 0; y < height; ++y)
+            equal = equal && std::equal(dst + y * dst_pitch, dst + y * dst_pitch + width, ref.begin() + y * dst_pitch);
+
+        check(equal, "%d-bit %s %s stream=1 mt opt=%d: differs from opt=0", bits, f.name, m.name, opt);
+    }
+}
+
+template <typename T>
+static void run(int max_opt, std::mt19937& rng)
+{
+    for (const Format& f : formats)
+    {
+        for (const Mode& m : modes)
+        {
+            for (int count : color_counts)
+            {
+                for (int w : widths)
+                    runTight<T>(f, m, count, (f.subsamplingX == 2) ? w + 1 : w, max_opt, rng);
+            }
+
+            runStream<T>(f, m, max_opt, rng);
+        }
+    }
+}
+
+int main()
+{
+    return runTest("kernels_test", []
+    {
+        const int max_opt = maxOpt();
+        std::mt19937 rng(1);
+
+        run<uint8_t>(max_opt, rng);
+        run<uint16_t>(max_opt, rng);
+
+        std::printf("opt 1..%d against opt=0\n", max_opt);
+    });
+}
@@ -0,0 +1,103 @@
+// Checks loadPalette(): binary palettes of both bit depths converted to the clip depth, text files in the colors
+// string syntax, the cache that is shared until the file changes, and the errors of missing and malformed files.
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "tcolormask_test.h"
+
+namespace fs = std::filesystem;
+
+static void writeFile(const fs::path& path, const std::string& data)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+static void appendLE(std::string& data, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        data.push_back(static_cast<char>(value >> (i * 8)));
+}
+
+static std::string binaryPalette(uint32_t bits, const std::vector<uint64_t>& colors, uint32_t count)
+{
+    std::string data(palette_magic, palette_magic_size);
+    appendLE(data, count, 4);
+    appendLE(data, bits, 4);
+    for (uint64_t color : colors)
+        appendLE(data, color, 8);
+
+    return data;
+}
+
+static std::vector<uint64_t> values(const std::vector<TColorMaskColor>& colors)
+{
+    std::vector<uint64_t> result;
+    for (const TColorMaskColor& color : colors)
+        result.push_back(color.value);
+
+    return result;
+}
+
+static bool throws(const std::string& path, int bits, const std::string& what)
+{
+    try { loadPalette(path, bits); }
+    catch (const std::runtime_error& e) { return std::string(e.what()).find(what) != std::string::npos; }
+
+    return false;
+}
+
+static void run(const fs::path& dir)
+{
+    const std::string bin8 = (dir / "palette8.bin").string();
+    writeFile(bin8, binaryPalette(8, { 0xFF0000, 0x123456, 0x000001 }, 3));
+
+    const auto colors = loadPalette(bin8, 8);
+    check(values(*colors) == std::vector<uint64_t>{ 0xFF0000, 0x123456, 0x000001 }, "8-bit palette: wrong colors");
+    check(values(*loadPalette(bin8, 16)) == std::vector<uint64_t>{ 0xFFFF00000000, 0x121234345656, 0x000000000101 }, "8-bit palette: wrong 16-bit colors");
+
+    const std::string bin16 = (dir / "palette16.bin").string();
+    writeFile(bin16, binaryPalette(16, { 0xFFFF00008080, 0x00FF7F7FFF00 }, 2));
+    check(values(*loadPalette(bin16, 8)) == std::vector<uint64_t>{ 0xFF0080, 0x017FFE }, "16-bit palette: wrong 8-bit colors");
+
+    // Shared until the file changes.
+    check(loadPalette(bin8, 8) == colors, "palette: loaded again without changes");
+    check(loadPalette(bin8, 16) != colors, "palette: shared between bit depths");
+
+    writeFile(bin8, binaryPalette(8, { 0xFF0000, 0x123456, 0x000001, 0x808080 }, 4));
+    const auto changed = loadPalette(bin8, 8);
+    check(changed != colors && changed->size() == 4 && colors->size() == 3, "palette: not reloaded after a change");
+
+    const std::string text = (dir / "palette.txt").string();
+    writeFile(text, "// colors\n$FF0000, 0x00FF00[20]\n| 16 /* gray */ $808080[1,2,3]\n");
+
+    const auto parsed = loadPalette(text, 8);
+    check(parsed->size() == 4 && (*parsed)[1].value == 0x00FF00 && (*parsed)[1].tolY == 20 && (*parsed)[2].value == 16 && (*parsed)[2].group == 1 && (*parsed)[3].tolV == 3,
+        "text palette: wrong colors");
+
+    check(throws(text, 16, "(colorfile " + text + ")"), "text palette: 8-bit colors accepted for 16-bit, or no path in the error");
+    check(throws((dir / "missing.bin").string(), 8, "cannot open colorfile"), "missing palette: no error");
+
+    const std::string bad = (dir / "bad.bin").string();
+    writeFile(bad, binaryPalette(8, {}, 0).substr(0, palette_magic_size + 4));
+    check(throws(bad, 8, "is truncated"), "truncated header: no error");
+    writeFile(bad, binaryPalette(8, { 0xFF0000 }, 2));
+    check(throws(bad, 8, "is truncated"), "truncated colors: no error");
+    writeFile(bad, binaryPalette(12, { 0xFF0000 }, 1));
+    check(throws(bad, 8, "unsupported bit depth"), "12-bit palette: no error");
+}
+
+int main()
+{
+    const fs::path dir = fs::temp_directory_path() / "tcolormask_palette_test";
+    fs::create_directories(dir);
+
+    const int result = runTest("palette_test", [&] { run(dir); });
+
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+
+    return result;
+}
@@ -0,0 +1,69 @@
+// Checks that malformed color strings are rejected with an error and valid ones give the expected colors,
+// tolerances and groups.
+
+#include <string>
+
+#include "tcolormask_test.h"
+
+static void run()
+{
+    struct Malformed
+    {
+        const char* str;
+        int bits;
+    };
+
+    static constexpr Malformed malformed[] = {
+        { "$", 8 },
+        { "0x", 8 },
+        { "$FFFFFG", 8 },
+        { "$FFFFFF$000000", 8 },
+        { "$FFFFFF abc", 8 },
+        { "$FFFFFF[", 8 },
+        { "$FFFFFF[10", 8 },
+        { "$FFFFFF[1,2]", 8 },
+        { "$FFFFFF[256]", 8 },
+        { "$FFFFFF /* comment", 8 },
+        { "$FFFFFF | $000000 | $808080 | $101010", 8 },
+        { "$FFFFFFFFFFFFFFFFF", 8 },
+        { "99999999999999999999", 8 },
+        { "$FFFFFF", 16 },
+        { "0xFFFF0000FF", 16 },
+    };
+
+    for (const Malformed& m : malformed)
+    {
+        bool thrown = false;
+
+        try { parseColors(m.str, m.bits); }
+        catch (const std::runtime_error&) { thrown = true; }
+
+        check(thrown, "parseColors(\"%s\", %d) accepted a malformed string", m.str, m.bits);
+    }
+
+    try
+    {
+        parseColors("$FFFFFF // comment\n  $FFFFFG", 8);
+    }
+    catch (const std::runtime_error& e)
+    {
+        check(std::string(e.what()).find("at line 2, column") != std::string::npos, "parseColors() error without the line: %s", e.what());
+    }
+
+    try
+    {
+        const std::vector<TColorMaskColor> colors = parseColors("$FFFFFF, 0x000000 // comment\n16 /* comment */ $808080[20] | $101010[1,2,3]", 8);
+
+        check(colors.size() == 5 && colors[2].value == 16 && colors[3].tolY == 20 && colors[4].group == 1 && colors[4].tolV == 3, "parseColors() returned wrong colors");
+        check(parseColors("0xFFFF0000FFFF", 16).at(0).value == 0xFFFF0000FFFF, "parseColors() returned a wrong 16-bit color");
+    }
+    catch (const std::runtime_error& e)
+    {
+        check(false, "parseColors() rejected a valid string: %s", e.what());
+    }
+}
+
+int main()
+{
+    return runTest("parser_test", run);
+}
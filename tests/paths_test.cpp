@@ -0,0 +1,236 @@
+// Checks processGroups(), processDelta() and processPacked() (semi-planar and YUY2) against process() for every
+// instruction set of the CPU, with the few color, LUT, euclid, soft, index, mt, region of interest and group paths.
+
+#include <algorithm>
+
+#include "tcolormask_test.h"
+
+struct TestCase
+{
+    const char* name;
+    int subsamplingX;
+    int subsamplingY;
+    int colors;
+    bool euclid;
+    bool soft;
+    bool index;
+    bool mt;
+    bool roi;
+    bool roiFill;
+    bool groups;
+};
+
+// The paths selected by the constructor: few colors (unrolled SIMD), many colors (LUT), euclid, soft, index, mt, ROI, groups.
+static constexpr TestCase cases[] = {
+    { "4:2:0 box 4 colors", 2, 2, 4, false, false, false, false, false, true, false },
+    { "4:2:0 box 12 colors (lut)", 2, 2, 12, false, false, false, false, false, true, false },
+    { "4:2:0 euclid 4 colors", 2, 2, 4, true, false, false, false, false, true, false },
+    { "4:2:0 euclid 12 colors (lut3d)", 2, 2, 12, true, false, false, false, false, true, false },
+    { "4:2:0 soft 4 colors", 2, 2, 4, false, true, false, false, false, true, false },
+    { "4:2:0 index 4 colors", 2, 2, 4, false, false, true, false, false, true, false },
+    { "4:2:0 box 4 colors mt", 2, 2, 4, false, false, false, true, false, true, false },
+    { "4:2:0 box 4 colors roi", 2, 2, 4, false, false, false, false, true, true, false },
+    { "4:2:0 box 4 colors roi fill=false", 2, 2, 4, false, false, false, true, true, false, false },
+    { "4:2:0 box 6 colors 2 groups", 2, 2, 6, false, false, false, false, false, true, true },
+    { "4:2:2 box 4 colors", 2, 1, 4, false, false, false, false, false, true, false },
+    { "4:2:2 box 12 colors (lut) mt", 2, 1, 12, false, false, false, true, false, true, false },
+    { "4:2:2 soft 4 colors roi 2 groups", 2, 1, 6, false, true, false, true, true, true, true },
+    { "4:4:4 box 4 colors", 1, 1, 4, false, false, false, false, false, true, false },
+    { "4:4:4 euclid 4 colors roi", 1, 1, 4, true, false, false, false, true, true, false },
+};
+
+template <typename T>
+struct Frame
+{
+    std::vector<T> Y;
+    std::vector<T> U;
+    std::vector<T> V;
+    YUVPlanes<T> planes;
+};
+
+// Width and height not multiple of the vector sizes and the 64x64 tiles, pitches with padding.
+static constexpr int width = 270;
+static constexpr int height = 100;
+static constexpr int pitch = width + 64;
+
+template <typename T>
+static bool equal(const std::vector<T>& a, const std::vector<T>& b, int w, int h)
+{
+    for (int y = 0; y < h; ++y)
+    {
+        if (!std::equal(a.begin() + static_cast<size_t>(y) * pitch, a.begin() + static_cast<size_t>(y) * pitch + w, b.begin() + static_cast<size_t>(y) * pitch))
+            return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+static void randomFrame(Frame<T>& frame, int height_uv, std::mt19937& rng)
+{
+    randomPlane(frame.Y, static_cast<size_t>(pitch) * height, rng);
+    randomPlane(frame.U, static_cast<size_t>(pitch) * height_uv, rng);
+    randomPlane(frame.V, frame.U.size(), rng);
+
+    frame.planes = { frame.Y.data(), frame.U.data(), frame.V.data(), pitch, pitch };
+}
+
+template <typename T>
+static void run(const TestCase& c, int opt, std::mt19937& rng)
+{
+    constexpr int bits = sizeof(T) * 8;
+    const int width_uv = width / c.subsamplingX;
+    const int height_uv = height / c.subsamplingY;
+
+    Frame<T> src;
+    randomFrame(src, height_uv, rng);
+
+    TColorMaskParams params;
+    params.width = width;
+    params.height = height;
+    params.subsamplingX = c.subsamplingX;
+    params.subsamplingY = c.subsamplingY;
+    params.euclid = c.euclid;
+    params.soft = c.soft;
+    params.index = c.index;
+    params.mt = c.mt;
+    params.opt = opt;
+    params.tolerance = (sizeof(T) == 1) ? 12 : 3072;
+    params.roiFill = c.roiFill;
+
+    if (c.roi)
+    {
+        params.roiLeft = 6;
+        params.roiTop = 4;
+        params.roiWidth = -10;
+        params.roiHeight = -8;
+    }
+
+    // Colors of the source pixels.
+    for (int i = 0; i < c.colors; ++i)
+    {
+        const int x = rng() % width;
+        const int y = rng() % height;
+        const size_t pos_uv = static_cast<size_t>(y / c.subsamplingY) * pitch + x / c.subsamplingX;
+
+        TColorMaskColor color{ packColor(src.Y[static_cast<size_t>(y) * pitch + x], src.U[pos_uv], src.V[pos_uv]) };
+        color.group = (c.groups) ? i % 2 : 0;
+        params.yuvColors.push_back(color);
+    }
+
+    TColorMaskEngines<T> engines(params, false);
+    const TColorMaskCore<T>* const* cores = engines.get(-1, -1);
+    const int groups = engines.groups();
+    const int dst_width = (c.roiFill) ? width : cores[0]->roiWidth();
+    const int dst_height = (c.roiFill) ? height : cores[0]->roiHeight();
+
+    auto masks = [&](T fill)
+    {
+        return std::vector<std::vector<T>>(groups, std::vector<T>(static_cast<size_t>(pitch) * dst_height, fill));
+    };
+
+    std::vector<std::vector<T>> ref = masks(0x5A);
+    for (int i = 0; i < groups; ++i)
+        cores[i]->process(ref[i].data(), src.Y.data(), src.U.data(), src.V.data(), pitch, pitch, pitch);
+
+    T* dst_ptrs[3];
+    int dst_pitches[3];
+
+    std::vector<std::vector<T>> dst = masks(0xA5);
+    for (int i = 0; i < groups; ++i)
+    {
+        dst_ptrs[i] = dst[i].data();
+        dst_pitches[i] = pitch;
+    }
+
+    TColorMaskCore<T>::processGroups(cores, groups, dst_ptrs, dst_pitches, src.planes);
+
+    for (int i = 0; i < groups; ++i)
+        check(equal(dst[i], ref[i], dst_width, dst_height), "%d-bit %s opt=%d: processGroups() differs from process()", bits, c.name, opt);
+
+    // A few changed pixels: processDelta() masks their tiles and copies the others from the previous mask.
+    Frame<T> next = src;
+    next.planes = { next.Y.data(), next.U.data(), next.V.data(), pitch, pitch };
+    for (int i = 0; i < 8; ++i)
+        next.Y[static_cast<size_t>(rng() % height) * pitch + rng() % width] ^= 0x15;
+    next.U[static_cast<size_t>(rng() % height_uv) * pitch + rng() % width_uv] ^= 0x15;
+
+    for (int i = 0; i < groups; ++i)
+    {
+        std::vector<T> next_ref(ref[i].size(), 0x5A);
+        cores[i]->process(next_ref.data(), next.Y.data(), next.U.data(), next.V.data(), pitch, pitch, pitch);
+
+        std::vector<T> delta(ref[i].size(), 0xA5);
+        cores[i]->processDelta(delta.data(), pitch, next.planes, ref[i].data(), pitch, src.planes);
+
+        check(equal(delta, next_ref, dst_width, dst_height), "%d-bit %s opt=%d: processDelta() differs from process()", bits, c.name, opt);
+    }
+
+    if (c.subsamplingX != 2)
+        return;
+
+    // Semi-planar (NV12/P010 style), and packed 4:2:2 (YUY2 style) for 4:2:2.
+    std::vector<T> uv(static_cast<size_t>(pitch) * 2 * height_uv);
+    for (int y = 0; y < height_uv; ++y)
+    {
+        for (int x = 0; x < width_uv; ++x)
+        {
+            uv[static_cast<size_t>(y) * pitch * 2 + x * 2] = src.U[static_cast<size_t>(y) * pitch + x];
+            uv[static_cast<size_t>(y) * pitch * 2 + x * 2 + 1] = src.V[static_cast<size_t>(y) * pitch + x];
+        }
+    }
+
+    dst = masks(0xA5);
+    for (int i = 0; i < groups; ++i)
+        dst_ptrs[i] = dst[i].data();
+
+    TColorMaskCore<T>::processPacked(cores, groups, dst_ptrs, dst_pitches, PackedPlanes<T>{ src.Y.data(), uv.data(), pitch, pitch * 2 });
+
+    for (int i = 0; i < groups; ++i)
+        check(equal(dst[i], ref[i], dst_width, dst_height), "%d-bit %s opt=%d: processPacked() semi-planar differs from process()", bits, c.name, opt);
+
+    if (c.subsamplingY != 1)
+        return;
+
+    std::vector<T> yuy2(static_cast<size_t>(pitch) * 2 * height);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width_uv; ++x)
+        {
+            T* p = yuy2.data() + static_cast<size_t>(y) * pitch * 2 + x * 4;
+            p[0] = src.Y[static_cast<size_t>(y) * pitch + x * 2];
+            p[1] = src.U[static_cast<size_t>(y) * pitch + x];
+            p[2] = src.Y[static_cast<size_t>(y) * pitch + x * 2 + 1];
+            p[3] = src.V[static_cast<size_t>(y) * pitch + x];
+        }
+    }
+
+    dst = masks(0xA5);
+    for (int i = 0; i < groups; ++i)
+        dst_ptrs[i] = dst[i].data();
+
+    TColorMaskCore<T>::processPacked(cores, groups, dst_ptrs, dst_pitches, PackedPlanes<T>{ yuy2.data(), nullptr, pitch * 2, 0 });
+
+    for (int i = 0; i < groups; ++i)
+        check(equal(dst[i], ref[i], dst_width, dst_height), "%d-bit %s opt=%d: processPacked() YUY2 differs from process()", bits, c.name, opt);
+}
+
+int main()
+{
+    return runTest("paths_test", []
+    {
+        const int max_opt = maxOpt();
+        std::mt19937 rng(1);
+
+        for (int opt = 0; opt <= max_opt; ++opt)
+        {
+            for (const TestCase& c : cases)
+            {
+                run<uint8_t>(c, opt, rng);
+                run<uint16_t>(c, opt, rng);
+            }
+        }
+
+        std::printf("opt 0..%d\n", max_opt);
+    });
+}
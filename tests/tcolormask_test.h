@@ -0,0 +1,81 @@
+#pragma once
+
+// Helpers shared by the tests. Each test is its own executable registered with CTest.
+
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "tcolormask_core.h"
+
+inline int failures = 0;
+
+template <typename... Args>
+inline void check(bool ok, const char* format, Args... args)
+{
+    if (!ok)
+    {
+        std::printf("FAIL ");
+        std::printf(format, args...);
+        std::printf("\n");
+        ++failures;
+    }
+}
+
+// Highest opt accepted by the constructor, it throws for instruction sets the CPU doesn't have.
+inline int maxOpt()
+{
+    TColorMaskParams params;
+    params.width = 64;
+    params.height = 64;
+    params.yuvColors.push_back({ 0x808080 });
+
+    int opt = 0;
+    for (; opt < 4; ++opt)
+    {
+        params.opt = opt + 1;
+
+        try { TColorMaskCore<uint8_t> core(params); }
+        catch (const std::runtime_error&) { break; }
+    }
+
+    return opt;
+}
+
+// Values in a narrow range around the middle, so that a part of the frame matches colors taken from it.
+template <typename T>
+inline void randomPlane(std::vector<T>& plane, size_t size, std::mt19937& rng)
+{
+    const int peak = (sizeof(T) == 1) ? 255 : 65535;
+
+    plane.resize(size);
+    for (T& x : plane)
+        x = static_cast<T>(peak / 2 + rng() % (peak / 8));
+}
+
+// Packed 0xYYUUVV / 0xRRGGBB color in the bit depth of T.
+template <typename T>
+inline uint64_t packColor(T a, T b, T c) noexcept
+{
+    constexpr int bits = sizeof(T) * 8;
+    return (static_cast<uint64_t>(a) << (2 * bits)) | (static_cast<uint64_t>(b) << bits) | c;
+}
+
+template <typename F>
+inline int runTest(const char* name, F&& test)
+{
+    try
+    {
+        test();
+    }
+    catch (const std::exception& e)
+    {
+        std::printf("FAIL %s: %s\n", name, e.what());
+        return 1;
+    }
+
+    std::printf("%s: %d failures\n", name, failures);
+
+    return (failures) ? 1 : 0;
+}